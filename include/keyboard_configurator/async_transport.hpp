@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "keyboard_configurator/device_transport.hpp"
+
+namespace kb::cfg {
+
+// Decorator that moves device writes onto a thread of its own, so a slow or
+// hung device never blocks the caller. Sends only queue the frame: a frame
+// still waiting when the next one arrives is replaced (its dirty reports are
+// carried over), so at most one write is ever pending. A write running
+// longer than `write_timeout` is reported as a stall, and sends return false
+// until it completes; the frames keep coalescing meanwhile.
+class AsyncTransport : public DeviceTransport {
+public:
+    // A zero timeout disables the watchdog.
+    AsyncTransport(std::unique_ptr<DeviceTransport> inner, std::chrono::milliseconds write_timeout);
+    // Flushes the pending frame. A writer stuck in the device past the
+    // timeout is abandoned together with the wrapped transport.
+    ~AsyncTransport() override;
+
+    AsyncTransport(const AsyncTransport&) = delete;
+    AsyncTransport& operator=(const AsyncTransport&) = delete;
+
+    std::string id() const override;
+    // Connects the wrapped transport on the calling thread
+    bool connect(const KeyboardModel& model) override;
+    // Both return false if an earlier write failed or the current one is
+    // stalled, i.e. when the device contents are no longer known.
+    bool sendFrame(const KeyboardModel& model,
+                   const std::vector<std::uint8_t>& payload) override;
+    bool sendReports(const KeyboardModel& model,
+                     const std::vector<std::uint8_t>& payload,
+                     const std::vector<std::uint8_t>& dirty) override;
+    TransportStats transportStats() const override;
+
+private:
+    struct State;
+
+    static void writerLoop(std::shared_ptr<State> state);
+    bool enqueue(const KeyboardModel& model,
+                 const std::vector<std::uint8_t>& payload,
+                 const std::vector<std::uint8_t>* dirty);
+
+    // Shared with the writer so an abandoned writer never dangles
+    std::shared_ptr<State> state_;
+    std::thread writer_;
+};
+
+}  // namespace kb::cfg
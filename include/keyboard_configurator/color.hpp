@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "keyboard_configurator/types.hpp"
+
+namespace kb::cfg {
+
+// Parses "#RRGGBB" (hex digits in either case).
+[[nodiscard]] std::optional<RgbColor> tryParseHexColor(const std::string& value);
+// As above, but malformed input yields `fallback`.
+[[nodiscard]] RgbColor parseHexColor(const std::string& value, RgbColor fallback = {255, 255, 255});
+
+// a + (b - a) * t, rounded; t is clamped to [0, 1].
+[[nodiscard]] std::uint8_t mix8(std::uint8_t a, std::uint8_t b, double t);
+[[nodiscard]] RgbColor mixColor(RgbColor a, RgbColor b, double t);
+
+// Hue in degrees (any value, wrapped into [0, 360)); s and v clamped to [0, 1].
+[[nodiscard]] RgbColor hsvToRgb(double hue_degrees, double s, double v);
+
+// Branch-free batch conversion of `count` hues at a shared saturation and
+// value. Meant for building tables rather than per-frame work.
+void hsvToRgb(const float* hue_degrees, float s, float v, RgbColor* out, std::size_t count);
+
+// Precomputed colour ramp over [0, 1]: presets map a scalar field to colours
+// with one table lookup per key instead of per-key interpolation.
+class GradientLut {
+public:
+    static constexpr std::size_t kDefaultSize = 1024;
+
+    GradientLut() = default;
+
+    // Even-spaced stops, blended linearly, or snapped to the nearest stop
+    // (matches lround(t * (stops - 1)) over the whole ramp).
+    [[nodiscard]] static GradientLut fromStops(const std::vector<RgbColor>& stops,
+                                               bool nearest = false,
+                                               std::size_t size = kDefaultSize);
+    // Full hue circle at fixed saturation/value; t = 0 and t = 1 are both red.
+    [[nodiscard]] static GradientLut hueWheel(double s, double v, std::size_t size = kDefaultSize);
+
+    [[nodiscard]] bool empty() const noexcept { return table_.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return table_.size(); }
+    [[nodiscard]] const RgbColor* data() const noexcept { return table_.data(); }
+
+    // t is clamped to [0, 1]; NaN maps to 0. The table must not be empty.
+    [[nodiscard]] RgbColor at(double t) const noexcept {
+        const double pos = t > 0.0 ? (t < 1.0 ? t * scale_ : scale_) : 0.0;
+        return table_[static_cast<std::size_t>(pos + 0.5)];
+    }
+    // Wraps t into [0, 1) first; for periodic ramps such as hueWheel.
+    [[nodiscard]] RgbColor wrapped(double t) const noexcept;
+
+    // Blends every entry toward `tint` by `amount` in [0, 1].
+    void tint(RgbColor tint, double amount);
+
+private:
+    std::vector<RgbColor> table_;
+    double scale_{0.0};   // size - 1
+};
+
+}  // namespace kb::cfg
@@ -8,8 +8,13 @@
 #include <optional>
 
 #include "keyboard_configurator/device_transport.hpp"
+#include "keyboard_configurator/frame_scheduler.hpp"
+#include "keyboard_configurator/key_mask.hpp"
 #include "keyboard_configurator/keyboard_model.hpp"
+#include "keyboard_configurator/layer_blend.hpp"
+#include "keyboard_configurator/output_stage.hpp"
 #include "keyboard_configurator/preset_registry.hpp"
+#include "keyboard_configurator/scene.hpp"
 #include "keyboard_configurator/types.hpp" // Ensure this exists or defines ParameterMap
 
 namespace kb::cfg {
@@ -30,8 +35,9 @@ struct HyprConfig {
     // std::unordered_map<std::string, std::vector<bool>> profile_enabled; // Old
     std::unordered_map<std::string, std::vector<std::size_t>> profile_draw_order; // NEW: Painter's List
     
-    // Keep masks (they still apply per-layer)
-    std::unordered_map<std::string, std::vector<std::vector<bool>>> profile_masks; 
+    // Keep masks (they still apply per-layer). Sized to the preset count at
+    // load time and shared with the scenes that use them.
+    std::unordered_map<std::string, MaskSetPtr> profile_masks;
     
     // Keep legacy enabled map for backward compatibility if needed
     std::unordered_map<std::string, std::vector<bool>> profile_enabled;
@@ -48,19 +54,43 @@ struct RuntimeConfig {
     std::vector<std::unique_ptr<LightingPreset>> presets;
     std::vector<ParameterMap> preset_parameters;
     std::chrono::milliseconds frame_interval{std::chrono::milliseconds{33}};
+    std::chrono::milliseconds keepalive_interval{std::chrono::milliseconds{1000}};
+    std::size_t render_threads{0}; // 0/1 = render layers serially
+    OverrunPolicy overrun_policy{OverrunPolicy::Skip};
+    IdlePolicy idle;
+    OutputSettings output;
     std::optional<std::uint16_t> interface_usage_page;
     std::optional<std::uint16_t> interface_usage;
     
-    std::vector<std::vector<bool>> preset_masks;
+    std::vector<KeyMask> preset_masks;
     std::vector<bool> preset_enabled;
+    std::vector<LayerBlend> preset_blend;
+    std::vector<std::vector<std::uint8_t>> preset_alpha; // empty = opaque
+    std::vector<double> preset_update_hz;                // 0 = preset default
     
     std::optional<HyprConfig> hypr;
+
+    std::string preview_ring{};          // shared-memory name; empty = off
+    std::size_t preview_slots{4};
+
+    // The transport queues writes on its own thread (AsyncTransport), which
+    // then replaces the engine's transport stage
+    bool async_writes{false};
 };
 
+// "hidapi", "hidraw", "logging" or "simulated" (default profile); throws
+// std::runtime_error otherwise.
+[[nodiscard]] std::unique_ptr<DeviceTransport> createTransport(const std::string& id);
+
 class ConfigLoader {
 public:
     explicit ConfigLoader(const PresetRegistry& registry);
+    // The first keyboard only; see loadDevicesFromFile()
     [[nodiscard]] RuntimeConfig loadFromFile(const std::string& path) const;
+    // One runtime per [[devices]] entry, or per [device] when there are none.
+    // Presets, profiles and shortcuts are shared sections but built separately
+    // for each keyboard, against its own layout.
+    [[nodiscard]] std::vector<RuntimeConfig> loadDevicesFromFile(const std::string& path) const;
 
 private:
     const PresetRegistry& registry_;
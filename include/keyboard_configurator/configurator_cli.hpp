@@ -2,12 +2,19 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "keyboard_configurator/frame_scheduler.hpp"
+#include "keyboard_configurator/key_activity.hpp"
+#include "keyboard_configurator/key_mask.hpp"
+#include "keyboard_configurator/scene.hpp"
 #include "keyboard_configurator/types.hpp"
 
 namespace kb::cfg {
@@ -24,13 +31,30 @@ public:
                     std::chrono::milliseconds frame_interval);
     ~ConfiguratorCLI();
 
+    // Starts the render thread and runs the interactive prompt until quit
     void run();
+    // Starts the render thread only, for keyboards without a prompt
+    void startRendering();
+
+    void setOverrunPolicy(OverrunPolicy policy);
+    // Idle detection needs key events; without a provider the loop never idles.
+    void setIdlePolicy(IdlePolicy policy, KeyActivityProviderPtr activity);
 
     // Watcher Interface (Public API)
+    // Copies the latest scene, applies `edit` and publishes the result in one
+    // step; concurrent writers retry instead of blocking. The render thread
+    // picks the scene up at its next frame boundary, waking for it if the
+    // scene is static or the keyboard idle.
+    void updateScene(const std::function<void(Scene&)>& edit);
+    [[nodiscard]] ScenePtr scene() const;
+
+    // Single-change shorthands for updateScene()
     void setDrawList(const std::vector<std::size_t>& list);
-    void applyPresetMasks(const std::vector<std::vector<bool>>& masks);
-    void applyPresetMask(std::size_t index, const std::vector<bool>& mask);
+    void applyPresetMasks(const std::vector<KeyMask>& masks);
+    void applyPresetMask(std::size_t index, const KeyMask& mask);
     void applyPresetParameter(std::size_t index, const std::string& key, const std::string& value);
+    // Asks the render thread for a frame of the latest scene; never renders
+    // on the caller's thread.
     void refreshRender();
 
     // Config Watch Interface
@@ -46,10 +70,22 @@ private:
     const KeyboardModel& model_;
     EffectEngine& engine_;
     
-    // Protects engine_ access from CLI thread vs Render thread
+    // Protects engine_ access from CLI thread vs Render thread. Never held
+    // across device I/O, and never taken by watchers, which only publish
+    // scenes.
     mutable std::mutex engine_mutex_;
-    
-    std::vector<ParameterMap> preset_parameters_;
+
+    const std::size_t preset_count_;
+
+    // Latest published scene, accessed only through std::atomic_load/_compare_exchange
+    ScenePtr scene_;
+
+    // Render-side view of the scene, guarded by engine_mutex_
+    std::uint64_t applied_scene_version_{0};
+    bool scene_reapply_{false};
+    std::vector<ParameterMap> applied_parameters_;
+    MaskSetPtr applied_masks_;  // masks are only pushed when the set changes
+    std::optional<std::size_t> snake_override_;
 
     // Render Loop State
     std::atomic<bool> stop_flag_;
@@ -57,6 +93,19 @@ private:
     std::atomic<bool> loop_running_;
     std::thread render_thread_;
     std::chrono::steady_clock::time_point start_time_;
+    FrameScheduler scheduler_;
+
+    // Idle mode; idle_policy_ and activity_ are set before the loop starts
+    IdlePolicy idle_policy_;
+    KeyActivityProviderPtr activity_;
+    std::atomic<bool> idle_{false};
+    std::atomic<std::uint64_t> idle_entries_{0};
+    // Set when the scene or engine changed after the last frame; a static or
+    // idle loop renders it once without leaving that state
+    std::atomic<bool> render_requested_{false};
+    // Wakes a static loop; only held to check or signal render_requested_
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
 
     // Config Watch State
     std::unique_ptr<ConfigWatcher> config_watcher_;
@@ -69,6 +118,7 @@ private:
     void printBanner() const;
     void printHelp() const;
     void printPresets();
+    void printStats() const;
     
     // Manual CLI Commands
     bool togglePreset(std::size_t index);
@@ -84,21 +134,15 @@ private:
     bool engineHasAnimated() const;
     void renderOnce(double time_seconds);
     void startRenderLoop();
+    bool waitWhileIdle();
+    bool waitForRenderRequest();
+    void requestRender();
+    void wakeRenderLoop();
     void stopRenderLoop();
-    void syncRenderState(bool refresh_static_frame);
+    void syncScene();
+    void applyScene(const Scene& scene);
     void applySnakeOverride(std::size_t snake_index);
     void clearSnakeOverride();
-
-    // Drawlist/mask tracking for overrides
-    std::vector<std::size_t> current_draw_list_;
-    std::vector<std::size_t> saved_draw_list_;
-    bool saved_draw_list_valid_ = false;
-
-    std::vector<std::vector<bool>> current_masks_;
-    std::vector<std::vector<bool>> saved_masks_;
-    bool saved_masks_valid_ = false;
-
-    bool snake_override_active_ = false;
 };
 
 }  // namespace kb::cfg
\ No newline at end of file
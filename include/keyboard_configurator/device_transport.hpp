@@ -9,14 +9,39 @@
 
 namespace kb::cfg {
 
+// Write-side counters reported by transports that track them; latencies
+// are in milliseconds over a window of recent writes.
+struct TransportStats {
+    std::uint64_t writes{0};
+    std::uint64_t write_failures{0};
+    std::uint64_t frames_coalesced{0};  // replaced while waiting for the writer
+    std::uint64_t write_stalls{0};      // writes that overran the watchdog
+    double latency_p50_ms{0.0};
+    double latency_p95_ms{0.0};
+    double latency_p99_ms{0.0};
+    double latency_max_ms{0.0};         // since start
+    bool device_connected{true};
+    std::uint64_t reconnects{0};
+};
+
 class DeviceTransport {
 public:
     virtual ~DeviceTransport() = default;
 
     virtual std::string id() const = 0;
     virtual bool connect(const KeyboardModel& model) = 0;
+    // `payload` holds model.reportCount() reports of model.packetLength()
+    // bytes each; all of them are sent.
     virtual bool sendFrame(const KeyboardModel& model,
                            const std::vector<std::uint8_t>& payload) = 0;
+    // Sends only the reports whose entry in `dirty` is non-zero. Transports
+    // that cannot address single reports send the whole frame.
+    virtual bool sendReports(const KeyboardModel& model,
+                             const std::vector<std::uint8_t>& payload,
+                             const std::vector<std::uint8_t>& /*dirty*/) {
+        return sendFrame(model, payload);
+    }
+    virtual TransportStats transportStats() const { return {}; }
 };
 
 }  // namespace kb::cfg
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "keyboard_configurator/preset.hpp"
+#include "keyboard_configurator/color.hpp"
 
 namespace kb::cfg {
 
@@ -25,8 +26,6 @@ private:
     void simulate(double delta_seconds);
     void igniteBaseRow();
     void propagateFlames();
-    [[nodiscard]] RgbColor colorForHeat(double heat) const;
-    static RgbColor parseHexColor(const std::string& value);
 
     double speed_{1.0};
     double cooling_{0.05};
@@ -41,6 +40,7 @@ private:
     std::vector<int> key_to_cell_;
     std::vector<double> heat_;
     std::vector<RgbColor> palette_;
+    GradientLut palette_lut_;   // heat 0..1 -> colour
 
     double last_time_{0.0};
     double accumulator_{0.0};
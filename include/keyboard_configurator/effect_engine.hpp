@@ -1,24 +1,56 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <thread>
 #include <vector>
 #include <string>
 
 #include "keyboard_configurator/device_transport.hpp"
+#include "keyboard_configurator/frame_mailbox.hpp"
 #include "keyboard_configurator/keyboard_model.hpp"
+#include "keyboard_configurator/layer_blend.hpp"
+#include "keyboard_configurator/output_stage.hpp"
 #include "keyboard_configurator/preset.hpp"
+#include "keyboard_configurator/render_pool.hpp"
+#include "keyboard_configurator/shared_frame_ring.hpp"
 #include "keyboard_configurator/key_activity.hpp"
 #include "keyboard_configurator/key_color_frame.hpp"
+#include "keyboard_configurator/key_mask.hpp"
 
 namespace kb::cfg {
 
 class EffectEngine {
 public:
+    // Counters describing the render path. scratch_allocations only moves when a
+    // per-layer buffer had to be (re)sized during renderFrame, so it stays flat
+    // in steady state.
+    struct RenderStats {
+        std::uint64_t frames_rendered{0};
+        std::uint64_t scratch_allocations{0};
+        std::uint64_t layer_renders{0};
+        std::uint64_t layer_cache_hits{0};
+        std::uint64_t layer_interpolations{0}; // frames served by blending a layer's last two renders
+        std::uint64_t layers_culled{0};
+        std::uint64_t frames_sent{0};
+        std::uint64_t frames_suppressed{0};
+        std::uint64_t frames_dropped{0};   // replaced in the stage's mailbox before being sent
+        std::uint64_t send_failures{0};
+        std::uint64_t reports_sent{0};
+        std::uint64_t reports_skipped{0};  // unchanged reports of a multi-report frame
+    };
+
     EffectEngine(const KeyboardModel& model, DeviceTransport& transport);
+    ~EffectEngine();
+
+    EffectEngine(const EffectEngine&) = delete;
+    EffectEngine& operator=(const EffectEngine&) = delete;
 
     void setPresets(std::vector<std::unique_ptr<LightingPreset>> presets);
     void setPresets(std::vector<std::unique_ptr<LightingPreset>> presets,
-                    std::vector<std::vector<bool>> masks);
+                    std::vector<KeyMask> masks);
 
     // --- NEW: Painter's Algorithm Support ---
     void setDrawList(std::vector<std::size_t> draw_list);
@@ -31,22 +63,89 @@ public:
     // Legacy methods
     void setPresetEnabled(std::size_t index, bool enabled);
     bool presetEnabled(std::size_t index) const;
-    void setPresetMask(std::size_t index, const std::vector<bool>& mask);
-    void setPresetMasks(const std::vector<std::vector<bool>>& masks, bool overlay_replace = false);
+    void setPresetMask(std::size_t index, const KeyMask& mask);
+    void setPresetMasks(const std::vector<KeyMask>& masks, bool overlay_replace = false);
+
+    // Per-layer compositing: blend mode/opacity and an optional per-key alpha
+    // (0..255) applied inside the layer's mask. An empty alpha means opaque.
+    void setPresetBlend(std::size_t index, LayerBlend blend);
+    void setPresetAlpha(std::size_t index, std::vector<std::uint8_t> alpha);
+
+    // Renders an animated layer at `hz` and interpolates between its last two
+    // renders on the device frames in between. 0 falls back to the preset's
+    // own updateRateHz().
+    void setPresetUpdateRate(std::size_t index, double hz);
+    // The device frame interval. Layers whose rate reaches the frame rate
+    // render every frame instead, as interpolating would only delay them.
+    void setFrameInterval(std::chrono::milliseconds interval);
+
+    // Reconfigures a preset and drops its cached output. Prefer this over
+    // presetAt(i).configure() so static layers pick up the change.
+    void configurePreset(std::size_t index, const ParameterMap& params);
 
     LightingPreset& presetAt(std::size_t index);
     const LightingPreset& presetAt(std::size_t index) const;
 
     bool hasAnimatedEnabled() const;
     void renderFrame(double time_seconds);
+    // Encodes the current frame and sends it unless it is byte-identical to the
+    // last frame sent and the keep-alive interval has not yet elapsed. With the
+    // transport stage running the frame is handed off instead of sent inline.
+    // Of a multi-report frame only the reports that changed are sent, except
+    // on keep-alive.
     bool pushFrame();
 
+    // Moves device writes onto a dedicated thread fed by a latest-wins mailbox,
+    // so the next frame renders while the previous one is on the wire. The
+    // transport must not be used by anyone else while the stage runs.
+    //
+    // Only for transports that write synchronously. One that queues writes on
+    // a thread of its own (AsyncTransport) already is the stage: running both
+    // would coalesce frames twice and split the drop counts, and the
+    // per-report diff would track a second queue rather than the device.
+    void startTransportStage();
+    // Sends any frame still in the mailbox, then joins the stage thread.
+    void stopTransportStage();
+
+    // Renders independent layers concurrently on a pool of `threads` threads
+    // (the render thread included); composition stays in draw order. 0 or 1
+    // keeps rendering serial. Presets must not share mutable state.
+    void setRenderThreads(std::size_t threads);
+
+    // Zero disables keep-alive resends: unchanged frames are never sent again.
+    void setKeepAliveInterval(std::chrono::milliseconds interval);
+
+    // Brightness, gamma, white balance and dithering applied to every
+    // composed frame; also switches composition to float linear light.
+    void setOutputSettings(const OutputSettings& settings);
+
+    // Publishes every rendered frame to `ring` for external previewers;
+    // null stops publishing.
+    void setFrameRing(std::shared_ptr<SharedFrameRing> ring);
+
+    [[nodiscard]] RenderStats renderStats() const;
+    // Write latency and stall counters, if the transport keeps them
+    [[nodiscard]] TransportStats transportStats() const;
+
 private:
     void applyKeyActivityProvider();
+    void ensureLayerFrames(std::size_t key_count);
+    void compileCoverage(std::size_t key_count);
+    void invalidateLayerCache();
+    void compileRenderPlan(std::size_t key_count);
+    void transportLoop();
+    bool deliver(const std::vector<std::uint8_t>& payload, bool force);
+    void drawLayer(std::size_t index, double time_seconds, KeyColorFrame& target);
+    void tickLayer(std::size_t index, double time_seconds);
+    void refreshLayerRates();
 
     const KeyboardModel& model_;
     DeviceTransport& transport_;
     KeyColorFrame frame_;
+    // Float working frame; only sized while the output stage is in use
+    LinearFrame linear_frame_;
+    OutputStage output_;
+    std::shared_ptr<SharedFrameRing> frame_ring_;
 
     std::vector<std::unique_ptr<LightingPreset>> presets_;
     
@@ -58,8 +157,82 @@ private:
     std::vector<bool> preset_enabled_;
     std::vector<std::size_t> active_draw_list_; // New List
     
-    std::vector<std::vector<bool>> preset_masks_;
+    std::vector<KeyMask> preset_masks_;
+    std::vector<LayerBlend> preset_blend_;
+    std::vector<std::vector<std::uint8_t>> preset_alpha_;
     KeyActivityProviderPtr key_activity_provider_;
+
+    // Mask x alpha x opacity folded into one weight per key, rebuilt only when
+    // one of its inputs changes. layer_touched_/layer_solid_ hold the keys with
+    // non-zero/full weight; layer_opaque_ marks layers with full coverage.
+    std::vector<std::vector<std::uint8_t>> layer_coverage_;
+    std::vector<KeyMask> layer_touched_;
+    std::vector<KeyMask> layer_solid_;
+    std::vector<bool> layer_opaque_;
+    bool coverage_dirty_{true};
+
+    // Occlusion-culled render plan: the layers to draw back-to-front and, per
+    // pass, the keys not hidden by an opaque layer above. Rebuilt only when the
+    // draw list, enabled set or coverage changes.
+    std::vector<std::size_t> render_order_;
+    std::vector<KeyMask> pass_visible_;
+    KeyMask covered_;
+    bool plan_dirty_{true};
+    // Distinct layers with a non-empty visible set, and per layer the union of
+    // its passes' visible keys.
+    std::vector<std::size_t> plan_layers_;
+    std::vector<std::vector<std::size_t>> layer_visible_;
+    std::vector<KeyMask> merged_visible_;
+
+    // Per-layer scratch frames, reused across renderFrame calls. For
+    // non-animated presets the frame doubles as a cache while layer_cached_ is set.
+    std::vector<KeyColorFrame> layer_frames_;
+    std::vector<bool> layer_cached_;
+    // Written from render jobs, hence bytes rather than vector<bool>
+    std::vector<std::uint8_t> layer_dropped_;
+    std::vector<std::uint8_t> layer_drawn_;
+
+    // Rate-limited layers keep their last two renders and the time of the
+    // newer one; layer_frames_ receives the blend between them.
+    struct LayerClock {
+        double rate_hz{0.0};
+        double last_tick{0.0};
+        bool primed{false};
+        KeyColorFrame previous;
+        KeyColorFrame current;
+    };
+    std::vector<double> preset_update_hz_;
+    double frame_interval_seconds_{0.0};  // 0 = unknown, throttle as configured
+    std::vector<LayerClock> layer_clocks_;
+    std::vector<std::size_t> pending_layers_;
+    std::unique_ptr<RenderPool> render_pool_;
+    RenderStats stats_;
+
+    // Delta suppression for pushFrame. Compared byte for byte, as a payload
+    // is only a few hundred bytes and a hash collision would drop a frame.
+    std::chrono::milliseconds keepalive_interval_{1000};
+    bool has_sent_frame_{false};
+    std::vector<std::uint8_t> last_sent_payload_;
+    std::chrono::steady_clock::time_point last_sent_time_{};
+    std::vector<std::uint8_t> payload_;
+
+    // Transport stage. The stage thread only touches transport_, the mailbox
+    // and the atomics below.
+    FrameMailbox mailbox_;
+    std::thread transport_thread_;
+    bool transport_stage_running_{false};
+    std::atomic<bool> send_failed_{false};
+    std::atomic<std::uint64_t> frames_sent_{0};
+    std::atomic<std::uint64_t> send_failures_{0};
+    std::atomic<std::uint64_t> reports_sent_{0};
+    std::atomic<std::uint64_t> reports_skipped_{0};
+    // What the device last acknowledged, for per-report dirty checks. Used
+    // by the stage thread while it runs and by pushFrame otherwise. Behind a
+    // queueing transport it is what was queued; that transport merges the
+    // dirty reports of frames it replaces and resends everything after a
+    // failed write, so the device still ends up with these bytes.
+    std::vector<std::uint8_t> device_payload_;
+    std::vector<std::uint8_t> dirty_reports_;
 };
 
 }  // namespace kb::cfg
\ No newline at end of file
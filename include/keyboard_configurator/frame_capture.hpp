@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "keyboard_configurator/keyboard_model.hpp"
+
+namespace kb::cfg {
+
+// Binary capture of encoded device payloads (".kbcap").
+//
+// After a header naming the device, each record is
+//   u8 kind, varint microseconds since the previous record, varint size
+// followed, for a key frame (kind 0), by the raw payload, or for a delta
+// (kind 1) by (varint unchanged, varint changed, changed bytes) runs against
+// the previous payload until `size` bytes are covered. Deltas need the same
+// size as the previous payload; a key frame is written at least every
+// kKeyFrameInterval records so a damaged file only loses a short stretch.
+// Varints are unsigned LEB128, fixed-width fields little-endian. The header
+// also carries the key count and report layout (header bytes, first key and
+// key count per report), so replays can be checked report by report.
+
+// Enough of the keyboard model to drive a transport on replay.
+struct CaptureHeader {
+    std::string name;
+    std::uint16_t vendor_id{0};
+    std::uint16_t product_id{0};
+    std::optional<std::uint16_t> usage_page;
+    std::optional<std::uint16_t> usage;
+    std::uint32_t packet_length{0};
+    std::size_t key_count{0};
+    std::vector<KeyboardModel::ReportChunk> chunks;
+
+    [[nodiscard]] static CaptureHeader fromModel(const KeyboardModel& model);
+    // A model with the captured report layout and placeholder key labels;
+    // payloads are already encoded. Throws std::runtime_error if the report
+    // layout is inconsistent.
+    [[nodiscard]] KeyboardModel toModel() const;
+};
+
+class CaptureWriter {
+public:
+    static constexpr std::uint64_t kKeyFrameInterval = 256;
+
+    // Throws std::runtime_error if the file cannot be created.
+    CaptureWriter(const std::filesystem::path& path, const CaptureHeader& header);
+
+    // `timestamp` counts from the start of the capture and should not go
+    // backwards; earlier values are clamped to the previous one.
+    void append(std::chrono::microseconds timestamp, const std::vector<std::uint8_t>& payload);
+    void flush();
+
+    [[nodiscard]] std::uint64_t frames() const noexcept { return frames_; }
+    [[nodiscard]] std::uint64_t bytesWritten() const noexcept { return bytes_; }
+
+private:
+    std::ofstream out_;
+    std::vector<std::uint8_t> previous_;
+    std::vector<std::uint8_t> record_;  // reused encode buffer
+    std::chrono::microseconds last_time_{0};
+    std::uint64_t frames_{0};
+    std::uint64_t since_key_frame_{0};
+    std::uint64_t bytes_{0};
+};
+
+class CaptureReader {
+public:
+    // Throws std::runtime_error if the file is missing or not a capture.
+    explicit CaptureReader(const std::filesystem::path& path);
+
+    [[nodiscard]] const CaptureHeader& header() const noexcept { return header_; }
+
+    // Advances to the next frame; false at the end of the file. Throws
+    // std::runtime_error on a corrupt record.
+    bool next();
+    // Back to the first frame
+    void rewind();
+
+    [[nodiscard]] std::chrono::microseconds timestamp() const noexcept { return time_; }
+    [[nodiscard]] const std::vector<std::uint8_t>& payload() const noexcept { return payload_; }
+
+private:
+    std::ifstream in_;
+    std::streampos data_start_{};
+    CaptureHeader header_;
+    std::size_t payload_size_{0};  // every frame's size, from the report layout
+    std::vector<std::uint8_t> payload_;
+    std::chrono::microseconds time_{0};
+};
+
+}  // namespace kb::cfg
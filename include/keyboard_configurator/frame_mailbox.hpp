@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace kb::cfg {
+
+// Single-slot, latest-wins handoff of encoded frames from the render stage to
+// the transport stage. Posting over a frame that has not been taken replaces
+// it, so the transport always sends the newest frame and never builds a
+// backlog. Buffers are swapped rather than copied and cycle between the two
+// stages, so steady-state handoff does not allocate.
+class FrameMailbox {
+public:
+    // Swaps `payload` into the slot; `payload` comes back holding a recycled
+    // buffer. `force` asks for every report to be resent (keep-alive) and
+    // survives replacement. Returns true if an unsent frame was replaced.
+    bool post(std::vector<std::uint8_t>& payload, bool force = false);
+
+    // Blocks until a frame is available or the mailbox is closed, then swaps
+    // it into `payload`. Returns false once closed and drained.
+    bool take(std::vector<std::uint8_t>& payload, bool& force);
+
+    void close();
+    void reopen();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::uint8_t> slot_;
+    bool full_{false};
+    bool force_{false};
+    bool closed_{false};
+};
+
+}  // namespace kb::cfg
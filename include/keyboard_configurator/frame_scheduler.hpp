@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace kb::cfg {
+
+enum class OverrunPolicy {
+    Skip,     // drop the frames whose deadlines already passed
+    CatchUp   // render missed frames back-to-back (bounded) to keep the count
+};
+
+[[nodiscard]] std::optional<OverrunPolicy> parseOverrunPolicy(const std::string& name);
+
+// After `timeout` without key presses the render loop drops to one frame per
+// `interval`, or stops rendering entirely when `interval` is zero, until the
+// next key press. A zero timeout disables idling.
+struct IdlePolicy {
+    std::chrono::milliseconds timeout{0};
+    std::chrono::milliseconds interval{0};
+};
+
+// Paces the render loop on absolute deadlines (start + n * period), so the
+// achieved rate does not depend on how long each frame takes to render.
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::uint64_t frames{0};
+        std::uint64_t overruns{0};        // waits that found whole periods already gone
+        std::uint64_t skipped_frames{0};
+        double last_period_ms{0.0};
+        double mean_period_ms{0.0};
+        double mean_jitter_ms{0.0};       // mean |actual period - target period|
+        double max_jitter_ms{0.0};
+    };
+
+    explicit FrameScheduler(std::chrono::milliseconds period,
+                            OverrunPolicy policy = OverrunPolicy::Skip);
+
+    // Starts a new schedule whose first deadline is `start`.
+    void reset(Clock::time_point start);
+    // Takes effect from the next deadline onwards.
+    void setPeriod(std::chrono::milliseconds period);
+    void setPolicy(OverrunPolicy policy);
+
+    // Sleeps until the next deadline, or returns at once when it already
+    // passed, and returns that deadline. Callers should animate with the
+    // returned time rather than now() so motion stays on the nominal grid.
+    Clock::time_point waitNext();
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    static constexpr std::int64_t kMaxCatchUpFrames = 3;
+
+    mutable std::mutex mutex_;  // guards everything below against stats() readers
+    Clock::duration period_;
+    OverrunPolicy policy_;
+    Clock::time_point next_deadline_{};
+    Clock::time_point last_wake_{};
+    bool has_last_wake_{false};
+    Stats stats_;
+    double period_sum_ms_{0.0};
+    double jitter_sum_ms_{0.0};
+    std::uint64_t period_samples_{0};
+};
+
+}  // namespace kb::cfg
@@ -20,17 +20,25 @@ public:
     bool connect(const KeyboardModel& model) override;
     bool sendFrame(const KeyboardModel& model,
                    const std::vector<std::uint8_t>& payload) override;
+    // Reports past the end of `dirty` are sent, so an empty one sends all
+    bool sendReports(const KeyboardModel& model,
+                     const std::vector<std::uint8_t>& payload,
+                     const std::vector<std::uint8_t>& dirty) override;
 
 private:
     struct HidDeleter {
         void operator()(hid_device* device) const noexcept;
     };
 
+    // Takes this transport's reference on the hidapi library; expects mutex_ held
     bool ensureInitialized();
     hid_device* openMatchingInterface(const KeyboardModel& model);
+    // Expects mutex_ held
+    bool sendReport(const KeyboardModel& model, const std::uint8_t* data, std::size_t size);
 
     std::mutex mutex_;
     std::unique_ptr<hid_device, HidDeleter> handle_;
+    bool initialized_{false};  // holds a reference on the hidapi library
 };
 
 }  // namespace kb::cfg
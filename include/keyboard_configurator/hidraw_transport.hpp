@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "keyboard_configurator/device_transport.hpp"
+
+namespace kb::cfg {
+
+// Linux hidraw transport: finds the /dev/hidrawN node matching the model's
+// VID/PID and interface usage once, then writes each report with a single
+// HIDIOCSFEATURE ioctl from a buffer allocated on connect. There is no
+// internal locking; calls must be serialised, as the engine's transport
+// stage and the transport decorators already do.
+class HidrawTransport : public DeviceTransport {
+public:
+    HidrawTransport() = default;
+    ~HidrawTransport() override;
+
+    HidrawTransport(const HidrawTransport&) = delete;
+    HidrawTransport& operator=(const HidrawTransport&) = delete;
+
+    std::string id() const override;
+    bool connect(const KeyboardModel& model) override;
+    bool sendFrame(const KeyboardModel& model,
+                   const std::vector<std::uint8_t>& payload) override;
+    bool sendReports(const KeyboardModel& model,
+                     const std::vector<std::uint8_t>& payload,
+                     const std::vector<std::uint8_t>& dirty) override;
+
+private:
+    void closeDevice();
+    bool sendReport(const std::uint8_t* data, std::size_t size);
+
+    int fd_{-1};
+    std::string node_;
+    std::vector<std::uint8_t> buffer_;  // one report
+};
+
+}  // namespace kb::cfg
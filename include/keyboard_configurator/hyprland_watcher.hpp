@@ -15,24 +15,36 @@ class ConfiguratorCLI;
 
 class HyprlandWatcher {
 public:
+    using ClassCallback = std::function<bool(const std::string&)>;
+
     HyprlandWatcher(HyprConfig cfg, ConfiguratorCLI& cli, std::size_t preset_count);
     ~HyprlandWatcher();
 
+    // Switches profiles on one more keyboard from the same event socket; call
+    // before start(). `on_class` works as setActiveClassCallback() does for
+    // the constructor's keyboard.
+    void addTarget(HyprConfig cfg, ConfiguratorCLI& cli, std::size_t preset_count,
+                   ClassCallback on_class = {});
+
     void start();
     void stop();
-    void setActiveClassCallback(std::function<bool(const std::string&)> cb) { on_class_ = std::move(cb); }
+    void setActiveClassCallback(ClassCallback cb) { targets_.front().on_class = std::move(cb); }
 
 private:
-    HyprConfig cfg_;
-    ConfiguratorCLI& cli_;
-    std::size_t preset_count_;
+    struct Target {
+        HyprConfig cfg;
+        ConfiguratorCLI* cli;
+        std::size_t preset_count;
+        ClassCallback on_class;
+    };
+    std::vector<Target> targets_;
     std::atomic<bool> stop_{false};
     std::thread thread_;
     std::string last_class_;
-    std::function<bool(const std::string&)> on_class_;
 
     static std::string autoDetectEventsSocket();
     void runLoop(std::string socket_path);
+    static void applyClass(Target& target, const std::string& app_class);
 };
 
 }  // namespace kb::cfg
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -28,13 +30,31 @@ public:
 
     [[nodiscard]] double nowSeconds() const;
 
+    // Time (nowSeconds() clock) of the latest key press. Construction counts
+    // as activity, so this starts at 0.
+    [[nodiscard]] double lastActivitySeconds() const;
+
+    // Bumped by every key press and by wake(). Read it before deciding to
+    // wait, then pass it to waitForActivity() so no press is missed.
+    [[nodiscard]] std::uint64_t activityGeneration() const;
+
+    // Blocks until the generation moves past `seen` (returns true) or until
+    // `deadline` (returns false).
+    bool waitForActivity(std::uint64_t seen, std::chrono::steady_clock::time_point deadline) const;
+
+    // Releases waiters without recording a key press, e.g. on shutdown.
+    void wake();
+
 private:
     const std::chrono::steady_clock::time_point start_time_;
     double history_window_seconds_;
     std::size_t key_count_;
 
     mutable std::mutex mutex_;
+    mutable std::condition_variable activity_cv_;
     mutable std::deque<Event> events_;
+    double last_activity_{0.0};
+    std::uint64_t generation_{0};
 
     void pruneStaleEvents(double current_time) const;
 };
@@ -19,16 +19,25 @@ public:
                        KeyActivityProviderPtr provider);
     ~KeyActivityWatcher();
 
+    // Feeds one more keyboard from the same input devices; call before start().
+    // Presses from an input device whose vendor/product matches a target's
+    // model go to that target only; other input devices feed every target.
+    void addTarget(const KeyboardModel& model, KeyActivityProviderPtr provider);
+
     void start();
     void stop();
 
 private:
-    const KeyboardModel& model_;
-    KeyActivityProviderPtr provider_;
+    struct Target {
+        const KeyboardModel* model;
+        KeyActivityProviderPtr provider;
+    };
+    std::vector<Target> targets_;
 
     struct DevHandle {
         int fd{-1};
         libevdev* dev{nullptr};
+        std::vector<std::size_t> targets; // empty = all
     };
 
     std::vector<DevHandle> devices_;
@@ -36,6 +45,7 @@ private:
     std::thread thread_;
 
     void runLoop();
+    static void recordPress(const Target& target, unsigned int code);
     void openDevices();
     void closeDevices();
 };
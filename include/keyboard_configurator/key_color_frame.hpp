@@ -10,6 +10,29 @@ namespace kb::cfg {
 
 class KeyboardModel;
 
+// Unchecked view over contiguous key colours. Obtain it through
+// KeyColorFrame::span(), which validates the size once, then index freely.
+template <typename T>
+class BasicColorSpan {
+public:
+    constexpr BasicColorSpan() noexcept = default;
+    constexpr BasicColorSpan(T* data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+    [[nodiscard]] constexpr T* data() const noexcept { return data_; }
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] constexpr T& operator[](std::size_t index) const noexcept { return data_[index]; }
+    [[nodiscard]] constexpr T* begin() const noexcept { return data_; }
+    [[nodiscard]] constexpr T* end() const noexcept { return data_ + size_; }
+
+private:
+    T* data_{nullptr};
+    std::size_t size_{0};
+};
+
+using ColorSpan = BasicColorSpan<RgbColor>;
+using ConstColorSpan = BasicColorSpan<const RgbColor>;
+
 class KeyColorFrame {
 public:
     explicit KeyColorFrame(std::size_t key_count = 0)
@@ -19,9 +42,18 @@ public:
 
     [[nodiscard]] std::size_t size() const noexcept { return colors_.size(); }
 
+    // Bounds-checked single-key access; prefer span() in per-key loops.
     void setColor(std::size_t index, RgbColor color);
     [[nodiscard]] RgbColor color(std::size_t index) const;
 
+    [[nodiscard]] RgbColor* data() noexcept { return colors_.data(); }
+    [[nodiscard]] const RgbColor* data() const noexcept { return colors_.data(); }
+    [[nodiscard]] ColorSpan span() noexcept { return {colors_.data(), colors_.size()}; }
+    [[nodiscard]] ConstColorSpan span() const noexcept { return {colors_.data(), colors_.size()}; }
+    // Throws std::out_of_range unless the frame holds at least `key_count` keys
+    [[nodiscard]] ColorSpan span(std::size_t key_count);
+    [[nodiscard]] ConstColorSpan span(std::size_t key_count) const;
+
     void fill(RgbColor color);
 
     [[nodiscard]] std::vector<RgbColor>& colors() noexcept { return colors_; }
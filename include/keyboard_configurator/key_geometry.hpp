@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kb::cfg {
+
+// Physical key outline in key units (1u = one standard key pitch); x/y is
+// the top-left corner, y grows downwards.
+struct KeyRect {
+    double x{0.0};
+    double y{0.0};
+    double width{1.0};
+    double height{1.0};
+
+    [[nodiscard]] double centerX() const noexcept { return x + width * 0.5; }
+    [[nodiscard]] double centerY() const noexcept { return y + height * 0.5; }
+};
+
+// Uniform-grid index over 2D points for radius and nearest-neighbour queries.
+class SpatialIndex {
+public:
+    SpatialIndex() = default;
+
+    // Indexes the points whose `include` entry is non-zero (all if empty).
+    void build(const std::vector<double>& xs,
+               const std::vector<double>& ys,
+               const std::vector<std::uint8_t>& include = {});
+
+    // Replaces `out` with the points within `radius` of (x, y), unordered.
+    void queryRadius(double x, double y, double radius, std::vector<std::size_t>& out) const;
+    // Replaces `out` with the `k` points closest to (x, y), nearest first.
+    void nearest(double x, double y, std::size_t k, std::vector<std::size_t>& out) const;
+
+    [[nodiscard]] std::size_t size() const noexcept { return points_.size(); }
+
+private:
+    struct Point {
+        double x;
+        double y;
+        std::size_t index;
+    };
+
+    [[nodiscard]] std::size_t cellX(double x) const noexcept;
+    [[nodiscard]] std::size_t cellY(double y) const noexcept;
+    template <typename Fn>
+    void forEachInRadius(double x, double y, double radius, Fn&& fn) const;
+
+    std::vector<Point> points_;            // grouped by cell
+    std::vector<std::size_t> cell_start_;  // cols * rows + 1 offsets into points_
+    std::size_t cols_{0};
+    std::size_t rows_{0};
+    double min_x_{0.0};
+    double min_y_{0.0};
+    double cell_w_{1.0};
+    double cell_h_{1.0};
+};
+
+// Per-key geometry shared read-only by every preset. Besides the physical
+// rectangles it keeps two normalised coordinate sets:
+//  - xs()/ys(): key centres stretched to [0, 1] on each axis
+//  - uniformXs()/uniformYs(): one scale for both axes, so distances are
+//    isotropic (the longer side spans [0, 1])
+// and a spatial index over xs()/ys() that skips "NAN" slots.
+class KeyGeometry {
+public:
+    KeyGeometry() = default;
+    KeyGeometry(std::vector<KeyRect> rects, const std::vector<std::string>& labels);
+
+    // Unit keys on the layout grid: entry c of layout row r sits at (c, r).
+    [[nodiscard]] static KeyGeometry fromLayout(const std::vector<std::vector<std::string>>& layout);
+
+    [[nodiscard]] std::size_t size() const noexcept { return rects_.size(); }
+    [[nodiscard]] const std::vector<KeyRect>& rects() const noexcept { return rects_; }
+    [[nodiscard]] const std::vector<double>& xs() const noexcept { return xs_; }
+    [[nodiscard]] const std::vector<double>& ys() const noexcept { return ys_; }
+    [[nodiscard]] const std::vector<double>& uniformXs() const noexcept { return uniform_xs_; }
+    [[nodiscard]] const std::vector<double>& uniformYs() const noexcept { return uniform_ys_; }
+    [[nodiscard]] const SpatialIndex& index() const noexcept { return index_; }
+
+private:
+    std::vector<KeyRect> rects_;
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> uniform_xs_;
+    std::vector<double> uniform_ys_;
+    SpatialIndex index_;
+};
+
+}  // namespace kb::cfg
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kb::cfg {
+
+// Per-key on/off set packed into 64-bit words. Bulk operations work a word at
+// a time; the list of set keys is built on first use and cached until the
+// next mutation, so indices() on the same mask must not race with writers.
+class KeyMask {
+public:
+    KeyMask() = default;
+    explicit KeyMask(std::size_t key_count, bool value = false);
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    [[nodiscard]] bool test(std::size_t index) const;
+    void set(std::size_t index, bool value = true);
+
+    void assign(std::size_t key_count, bool value);
+    void fill(bool value);
+
+    [[nodiscard]] std::size_t count() const noexcept;
+    [[nodiscard]] bool any() const noexcept;
+    [[nodiscard]] bool all() const noexcept { return count() == size_; }
+
+    // Both operands must have the same size.
+    KeyMask& operator|=(const KeyMask& other);
+    KeyMask& operator&=(const KeyMask& other);
+    KeyMask& andNot(const KeyMask& other);
+
+    [[nodiscard]] bool operator==(const KeyMask& other) const noexcept;
+    [[nodiscard]] bool operator!=(const KeyMask& other) const noexcept { return !(*this == other); }
+
+    // Ascending indices of the set keys.
+    [[nodiscard]] const std::vector<std::size_t>& indices() const;
+
+    // dst[k] = test(k) ? on : off for every key.
+    void select(std::uint8_t* dst, std::uint8_t on, std::uint8_t off) const noexcept;
+
+    [[nodiscard]] const std::vector<std::uint64_t>& words() const noexcept { return words_; }
+
+private:
+    void requireSameSize(const KeyMask& other, const char* op) const;
+    void clearTail() noexcept;
+
+    std::size_t size_{0};
+    std::vector<std::uint64_t> words_;
+    mutable std::vector<std::size_t> indices_;
+    mutable bool indices_valid_{false};
+};
+
+}  // namespace kb::cfg
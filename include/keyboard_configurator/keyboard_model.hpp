@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
@@ -7,17 +8,31 @@
 #include <unordered_map>
 #include <vector>
 
+#include "keyboard_configurator/key_geometry.hpp"
 #include "keyboard_configurator/types.hpp"
 
 namespace kb::cfg {
 
 class KeyColorFrame;
 
+// Byte order of each key's colour on the wire
+enum class ChannelOrder { RGB, RBG, GRB, GBR, BRG, BGR };
+
+[[nodiscard]] std::optional<ChannelOrder> parseChannelOrder(const std::string& name);
+
 class KeyboardModel {
 public:
     using LayoutRow = std::vector<std::string>;
     using Layout = std::vector<LayoutRow>;
 
+    // One feature report of packet_length bytes: `header`, then the colours
+    // of keys [first_key, first_key + key_count), zero padded.
+    struct ReportChunk {
+        std::vector<std::uint8_t> header;
+        std::size_t first_key{0};
+        std::size_t key_count{0};
+    };
+
     KeyboardModel(std::string name,
                   std::uint16_t vendor_id,
                   std::uint16_t product_id,
@@ -44,9 +59,40 @@ public:
 
     void setKeycodeMap(const std::vector<int>& keycodes);
 
+    // Physical key positions, by default unit keys on the layout grid.
+    // Throws std::invalid_argument unless there is one rect per layout slot.
+    [[nodiscard]] const KeyGeometry& geometry() const noexcept { return geometry_; }
+    void setKeyGeometry(std::vector<KeyRect> rects);
+
+    void setChannelOrder(ChannelOrder order);
+    [[nodiscard]] ChannelOrder channelOrder() const noexcept { return encode_plan_.channel_order; }
+
+    // Splits the frame across several reports. Throws std::invalid_argument
+    // if a chunk does not fit packet_length or runs past the last key. An
+    // empty list restores the default single report (packet_header, all keys).
+    void setReportChunks(std::vector<ReportChunk> chunks);
+    [[nodiscard]] const std::vector<ReportChunk>& reportChunks() const noexcept { return chunks_; }
+    [[nodiscard]] std::size_t reportCount() const noexcept { return chunks_.size(); }
+    // Encoded frames are reportCount() reports of packetLength() bytes, back to back
+    [[nodiscard]] std::size_t payloadSize() const noexcept { return chunks_.size() * packet_length_; }
+
     [[nodiscard]] std::vector<std::uint8_t> encodeFrame(const KeyColorFrame& frame) const;
+    // Encodes into `payload`, reusing its capacity; the hot-path variant.
+    void encodeFrame(const KeyColorFrame& frame, std::vector<std::uint8_t>& payload) const;
 
 private:
+    // Built once from the layout and chunks: everything encodeFrame needs
+    // besides the colours, so encoding is a header and colour copy per report
+    // and a few stores.
+    struct EncodePlan {
+        std::vector<std::size_t> blank_offsets;  // payload offsets of "NAN" slots, always sent black
+        ChannelOrder channel_order{ChannelOrder::RGB};
+        std::array<std::uint8_t, 3> channel_map{0, 1, 2};
+        bool fits{true};                         // every chunk fits packet_length
+    };
+
+    void compileEncodePlan();
+
     std::string name_;
     std::uint16_t vendor_id_;
     std::uint16_t product_id_;
@@ -56,8 +102,11 @@ private:
     std::vector<std::string> key_labels_;
     std::unordered_map<std::string, std::size_t> key_to_index_;
     std::vector<std::size_t> keycode_to_index_;
+    KeyGeometry geometry_;
     std::optional<std::uint16_t> interface_usage_page_;
     std::optional<std::uint16_t> interface_usage_;
+    std::vector<ReportChunk> chunks_;
+    EncodePlan encode_plan_;
 };
 
 }  // namespace kb::cfg
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "keyboard_configurator/types.hpp"
+
+namespace kb::cfg {
+
+enum class BlendMode {
+    Alpha,     // layer replaces what is below, weighted by coverage
+    Add,
+    Multiply,
+    Screen,
+    Max
+};
+
+struct LayerBlend {
+    BlendMode mode{BlendMode::Alpha};
+    std::uint8_t opacity{255};
+};
+
+[[nodiscard]] std::optional<BlendMode> parseBlendMode(const std::string& name);
+
+// Composites `count` keys of `src` onto `dst`. `coverage` holds a per-key
+// weight in 0..255 (opacity already folded in); nullptr means fully covered.
+void blendLayer(BlendMode mode,
+                RgbColor* dst,
+                const RgbColor* src,
+                const std::uint8_t* coverage,
+                std::size_t count);
+
+// dst = from + (to - from) * t / 255 per channel, for `count` keys.
+void lerpFrames(RgbColor* dst,
+                const RgbColor* from,
+                const RgbColor* to,
+                std::uint8_t t,
+                std::size_t count);
+
+}  // namespace kb::cfg
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "keyboard_configurator/preset.hpp"
+#include "keyboard_configurator/color.hpp"
 
 namespace kb::cfg {
 
@@ -13,6 +14,10 @@ public:
     void render(const KeyboardModel& model,
                 double time_seconds,
                 KeyColorFrame& frame) override;
+    void renderVisible(const KeyboardModel& model,
+                       double time_seconds,
+                       KeyColorFrame& frame,
+                       const std::vector<std::size_t>& visible) override;
     [[nodiscard]] bool isAnimated() const noexcept override { return true; }
     void setKeyActivityProvider(KeyActivityProviderPtr provider) override { provider_ = std::move(provider); }
 
@@ -26,6 +31,7 @@ private:
     enum class MixMode { Linear, Nearest };
     MixMode mix_mode_{MixMode::Linear};
     std::vector<RgbColor> palette_{}; // up to 10 colors
+    GradientLut lut_;                 // palette (or hue wheel) over the plasma value
 
     // --- Reactive Config ---
     bool reactive_enabled_{false};
@@ -44,11 +50,14 @@ private:
     bool reactive_splash_enabled_{false};   // Upgrade 3: Drifts with liquid flow
 
     // --- Internal State ---
-    bool coords_built_{false};
-    std::vector<double> xs_;
-    std::vector<double> ys_;
-    void buildCoords(const KeyboardModel& model);
-    bool computeReactiveFields(std::vector<double>& disp_x,
+    std::vector<std::size_t> nearby_;  // spatial query scratch
+    void renderKeys(const KeyboardModel& model,
+                    double time_seconds,
+                    KeyColorFrame& frame,
+                    const std::vector<std::size_t>* visible);
+    void buildLut();
+    bool computeReactiveFields(const KeyGeometry& geometry,
+                               std::vector<double>& disp_x,
                                std::vector<double>& disp_y,
                                std::vector<double>& phase_shift);
 };
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "keyboard_configurator/layer_blend.hpp"
+#include "keyboard_configurator/types.hpp"
+
+namespace kb::cfg {
+
+class KeyboardModel;
+
+// Device-side colour correction. Presets author 8-bit colours; with
+// linear_blend the layers are composed in float linear light instead of
+// 8-bit, and the output stage quantises once at the end.
+struct OutputSettings {
+    double brightness{1.0};
+    // Exponent applied to the authored 0..1 value (out = in^gamma), so 1.0
+    // leaves colours untouched and ~2.2 suits LEDs with linear PWM.
+    double gamma{1.0};
+    // Row-major 3x3 matrix applied in linear light
+    std::array<float, 9> white_balance{1.0f, 0.0f, 0.0f,
+                                       0.0f, 1.0f, 0.0f,
+                                       0.0f, 0.0f, 1.0f};
+    bool dither{false};
+    bool linear_blend{false};
+};
+
+// Structure-of-arrays float frame in linear light, one plane per channel.
+class LinearFrame {
+public:
+    explicit LinearFrame(std::size_t key_count = 0) { resize(key_count); }
+
+    void resize(std::size_t key_count);
+    void clear();
+
+    [[nodiscard]] std::size_t size() const noexcept { return r_.size(); }
+
+    [[nodiscard]] float* r() noexcept { return r_.data(); }
+    [[nodiscard]] float* g() noexcept { return g_.data(); }
+    [[nodiscard]] float* b() noexcept { return b_.data(); }
+    [[nodiscard]] const float* r() const noexcept { return r_.data(); }
+    [[nodiscard]] const float* g() const noexcept { return g_.data(); }
+    [[nodiscard]] const float* b() const noexcept { return b_.data(); }
+
+    // Replaces the contents with the linear-light decode of `count` 8-bit keys
+    void decode(const RgbColor* src, std::size_t count);
+
+private:
+    std::vector<float> r_;
+    std::vector<float> g_;
+    std::vector<float> b_;
+};
+
+// Float counterpart of blendLayer: composites `count` 8-bit keys of `src`,
+// decoded to linear light, onto `dst`. Values are not clamped, so additive
+// stacks keep their headroom until the output stage.
+void blendLayerLinear(BlendMode mode,
+                      LinearFrame& dst,
+                      const RgbColor* src,
+                      const std::uint8_t* coverage,
+                      std::size_t count);
+
+// One fused pass from the linear working frame to device bytes: white
+// balance and brightness (folded into one matrix), gamma through a LUT,
+// optional temporal dithering and blanking of NAN layout slots.
+class OutputStage {
+public:
+    OutputStage();
+
+    void configure(const OutputSettings& settings);
+    [[nodiscard]] const OutputSettings& settings() const noexcept { return settings_; }
+
+    // Marks the model's "NAN" slots so they are always written black.
+    void setLayout(const KeyboardModel& model);
+
+    // True when the stage would reproduce 8-bit input exactly (apart from
+    // NAN blanking, which encodeFrame does anyway) and can be skipped.
+    [[nodiscard]] bool isIdentity() const noexcept { return identity_; }
+    [[nodiscard]] bool linearBlend() const noexcept { return settings_.linear_blend; }
+
+    // Writes `frame.size()` keys to `out`
+    void process(const LinearFrame& frame, RgbColor* out);
+
+private:
+    static constexpr std::size_t kLutSize = 4096;
+
+    OutputSettings settings_;
+    std::array<float, 9> matrix_{};
+    // Indexed by sqrt(linear) so dark values keep resolution; entries are
+    // output levels in 8.8 fixed point.
+    std::vector<std::uint16_t> lut_;
+    std::vector<std::uint8_t> keep_;    // 0x00 for NAN slots, 0xFF otherwise
+    std::vector<std::uint16_t> index_;  // per-frame scratch, 3 planes
+    std::uint32_t frame_counter_{0};
+    bool identity_{true};
+};
+
+}  // namespace kb::cfg
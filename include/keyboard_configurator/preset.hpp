@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 #include "keyboard_configurator/key_activity.hpp"
 #include "keyboard_configurator/key_color_frame.hpp"
@@ -18,6 +20,19 @@ public:
     virtual void render(const KeyboardModel& model,
                         double time_seconds,
                         KeyColorFrame& frame) = 0;
+    // Called instead of render() when only `visible` keys (ascending indices)
+    // survive composition. Keys outside the list may be left untouched, but
+    // time-driven state must advance exactly as in render().
+    virtual void renderVisible(const KeyboardModel& model,
+                               double time_seconds,
+                               KeyColorFrame& frame,
+                               const std::vector<std::size_t>& visible) {
+        (void)visible;
+        render(model, time_seconds, frame);
+    }
+    // Rate at which the preset needs fresh renders; the engine interpolates in
+    // between. 0 means every device frame.
+    [[nodiscard]] virtual double updateRateHz() const noexcept { return 0.0; }
     [[nodiscard]] virtual bool isAnimated() const noexcept { return false; }
     virtual void setKeyActivityProvider(KeyActivityProviderPtr provider) {
         (void)provider;
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include "keyboard_configurator/preset.hpp"
+#include "keyboard_configurator/color.hpp"
 
 namespace kb::cfg {
 
@@ -11,9 +14,18 @@ public:
     void render(const KeyboardModel& model,
                 double time_seconds,
                 KeyColorFrame& frame) override;
+    void renderVisible(const KeyboardModel& model,
+                       double time_seconds,
+                       KeyColorFrame& frame,
+                       const std::vector<std::size_t>& visible) override;
     [[nodiscard]] bool isAnimated() const noexcept override { return true; }
 
 private:
+    void renderKeys(const KeyboardModel& model,
+                    double time_seconds,
+                    KeyColorFrame& frame,
+                    const std::vector<std::size_t>* visible);
+    void buildLut();
     double speed_{0.5};
     double scale_{0.15};
     double saturation_{1.0};
@@ -21,6 +33,7 @@ private:
     bool use_tint_{false};
     double tint_mix_{0.5};
     RgbColor tint_{};
+    GradientLut lut_;   // hue wheel with the tint folded in
 };
 
 }  // namespace kb::cfg
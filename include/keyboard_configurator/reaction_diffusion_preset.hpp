@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "keyboard_configurator/preset.hpp"
+#include "keyboard_configurator/color.hpp"
 
 namespace kb::cfg {
 
@@ -13,6 +14,10 @@ public:
     void render(const KeyboardModel& model,
                 double time_seconds,
                 KeyColorFrame& frame) override;
+    void renderVisible(const KeyboardModel& model,
+                       double time_seconds,
+                       KeyColorFrame& frame,
+                       const std::vector<std::size_t>& visible) override;
     [[nodiscard]] bool isAnimated() const noexcept override { return true; }
     void setKeyActivityProvider(KeyActivityProviderPtr provider) override {
         key_activity_provider_ = std::move(provider);
@@ -30,6 +35,7 @@ private:
     double speed_{1.0};
     RgbColor color_a_{0,0,0};
     RgbColor color_b_{255,255,255};
+    GradientLut lut_;   // color_a -> color_b
 
     bool inited_{false};
     double last_time_{0.0};
@@ -43,13 +49,13 @@ private:
     double injection_decay_{0.6};
     double injection_history_{1.5};
 
-    bool coords_built_{false};
-    std::vector<double> xs_;
-    std::vector<double> ys_;
-    void buildCoords(const KeyboardModel& model);
+    void renderKeys(const KeyboardModel& model,
+                    double time_seconds,
+                    KeyColorFrame& frame,
+                    const std::vector<std::size_t>* visible);
     void initGrid();
     void step(double dt);
-    void applyKeyActivityInjection();
+    void applyKeyActivityInjection(const KeyGeometry& geometry);
 };
 
 }  // namespace kb::cfg
@@ -13,12 +13,17 @@ public:
     void render(const KeyboardModel& model,
                 double time_seconds,
                 KeyColorFrame& frame) override;
+    void renderVisible(const KeyboardModel& model,
+                       double time_seconds,
+                       KeyColorFrame& frame,
+                       const std::vector<std::size_t>& visible) override;
     [[nodiscard]] bool isAnimated() const noexcept override { return true; }
     void setKeyActivityProvider(KeyActivityProviderPtr provider) override;
 
 private:
-    void buildCoords(const KeyboardModel& model);
-    static RgbColor parseHexColor(const std::string& value);
+    void renderKeys(const KeyboardModel& model,
+                    KeyColorFrame& frame,
+                    const std::vector<std::size_t>* visible);
 
     KeyActivityProviderPtr provider_;
 
@@ -30,9 +35,8 @@ private:
     RgbColor ripple_color_{0, 170, 255};
     RgbColor base_color_{0, 0, 0};
 
-    bool coords_built_{false};
-    std::vector<double> xs_;
-    std::vector<double> ys_;
+    std::vector<double> contributions_;
+    std::vector<std::size_t> nearby_;  // spatial query scratch
 };
 
 }  // namespace kb::cfg
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "keyboard_configurator/device_transport.hpp"
+
+namespace kb::cfg {
+
+// Decorator that survives the device going away. A failed connect or write
+// marks the device as lost; a background thread then reconnects with
+// exponential backoff while sends go to a null sink, keeping only the newest
+// frame. Once the device is back that frame is sent in full before normal
+// writes resume, so the keyboard shows what the engine last rendered.
+class ReconnectingTransport : public DeviceTransport {
+public:
+    struct Backoff {
+        std::chrono::milliseconds initial{500};
+        std::chrono::milliseconds max{30000};
+        double multiplier{2.0};
+    };
+
+    ReconnectingTransport(std::unique_ptr<DeviceTransport> inner, Backoff backoff);
+    ~ReconnectingTransport() override;
+
+    ReconnectingTransport(const ReconnectingTransport&) = delete;
+    ReconnectingTransport& operator=(const ReconnectingTransport&) = delete;
+
+    std::string id() const override;
+    // Tries once and always succeeds; if the device is absent the
+    // background thread keeps trying, so startup never waits for it.
+    bool connect(const KeyboardModel& model) override;
+    // Never fail: frames that cannot be written are held for the reconnect
+    bool sendFrame(const KeyboardModel& model,
+                   const std::vector<std::uint8_t>& payload) override;
+    bool sendReports(const KeyboardModel& model,
+                     const std::vector<std::uint8_t>& payload,
+                     const std::vector<std::uint8_t>& dirty) override;
+    TransportStats transportStats() const override;
+
+private:
+    bool send(const KeyboardModel& model,
+              const std::vector<std::uint8_t>& payload,
+              const std::vector<std::uint8_t>* dirty);
+    void reconnectLoop();
+
+    std::unique_ptr<DeviceTransport> inner_;
+    Backoff backoff_;
+
+    // inner_ is used by senders while connected_ and not catching_up_, and
+    // by the reconnect thread otherwise, never by both at once. mutex_
+    // guards the state below and is never held across a device write.
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unique_ptr<KeyboardModel> model_;   // for reconnects, copied on connect
+    std::vector<std::uint8_t> latest_;       // newest frame while disconnected
+    std::uint64_t latest_generation_{0};     // bumped whenever latest_ is replaced
+    bool has_latest_{false};
+    bool connected_{false};
+    bool catching_up_{false};                // the reconnect thread still owns inner_
+    bool stop_{false};
+    std::uint64_t reconnects_{0};
+    std::thread thread_;
+    std::vector<std::uint8_t> resend_;       // reconnect thread's copy of latest_
+};
+
+}  // namespace kb::cfg
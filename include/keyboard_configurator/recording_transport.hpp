@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "keyboard_configurator/device_transport.hpp"
+#include "keyboard_configurator/frame_capture.hpp"
+
+namespace kb::cfg {
+
+// Appends every frame handed to the transport to a binary capture (see
+// frame_capture.hpp) with its time since connect, then forwards it to the
+// wrapped transport. With no wrapped transport frames are only recorded.
+class RecordingTransport : public DeviceTransport {
+public:
+    RecordingTransport(std::unique_ptr<DeviceTransport> inner, std::filesystem::path path);
+    ~RecordingTransport() override;
+
+    std::string id() const override;
+    // Creates the capture file on first use; throws std::runtime_error if
+    // it cannot be written.
+    bool connect(const KeyboardModel& model) override;
+    bool sendFrame(const KeyboardModel& model,
+                   const std::vector<std::uint8_t>& payload) override;
+    bool sendReports(const KeyboardModel& model,
+                     const std::vector<std::uint8_t>& payload,
+                     const std::vector<std::uint8_t>& dirty) override;
+    TransportStats transportStats() const override;
+
+private:
+    void record(const KeyboardModel& model, const std::vector<std::uint8_t>& payload);
+    // Expects mutex_ held
+    void open(const KeyboardModel& model);
+
+    std::unique_ptr<DeviceTransport> inner_;
+    std::filesystem::path path_;
+    std::mutex mutex_;
+    std::unique_ptr<CaptureWriter> writer_;
+    std::chrono::steady_clock::time_point start_{};
+    std::chrono::steady_clock::time_point last_flush_{};
+};
+
+}  // namespace kb::cfg
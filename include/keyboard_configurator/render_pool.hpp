@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kb::cfg {
+
+// Fixed set of threads that run a batch of independent jobs and block the
+// caller until the whole batch has finished. The calling thread works on the
+// batch too, so a pool of N threads only spawns N - 1 workers.
+class RenderPool {
+public:
+    explicit RenderPool(std::size_t threads);
+    ~RenderPool();
+
+    RenderPool(const RenderPool&) = delete;
+    RenderPool& operator=(const RenderPool&) = delete;
+
+    [[nodiscard]] std::size_t threadCount() const noexcept { return workers_.size() + 1; }
+
+    // Runs job(0) .. job(count - 1). The first exception thrown by a job is
+    // rethrown here once every job has completed.
+    void run(std::size_t count, const std::function<void(std::size_t)>& job);
+
+private:
+    void workerLoop();
+    void drain(const std::function<void(std::size_t)>& job, std::size_t count);
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+
+    // Batch state, guarded by mutex_
+    const std::function<void(std::size_t)>* job_{nullptr};
+    std::size_t job_count_{0};
+    std::size_t next_job_{0};
+    std::size_t pending_{0};
+    std::size_t active_workers_{0};
+    std::uint64_t generation_{0};
+    std::exception_ptr error_;
+    bool stopping_{false};
+};
+
+}  // namespace kb::cfg
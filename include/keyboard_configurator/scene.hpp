@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "keyboard_configurator/key_mask.hpp"
+#include "keyboard_configurator/types.hpp"
+
+namespace kb::cfg {
+
+// Per-preset masks, shared between scenes and the profile they came from
+using MaskSet = std::vector<KeyMask>;
+using MaskSetPtr = std::shared_ptr<const MaskSet>;
+
+// What the render thread should draw: the painter's list plus per-preset masks
+// and parameters. Published scenes are never modified; writers copy the latest
+// one, edit the copy and publish it as a whole, so a frame never sees half of
+// an update.
+struct Scene {
+    std::vector<std::size_t> draw_list;
+    // Indexed by preset; null or empty masks leave the engine's mask
+    // untouched. Shared, so switching profiles only swaps the pointer.
+    MaskSetPtr masks;
+    // Indexed by preset; the complete parameter set each preset should run with.
+    std::vector<ParameterMap> parameters;
+    std::uint64_t version{0};
+
+    // Copies the mask set before changing it, as other scenes may share it
+    void setMask(std::size_t index, KeyMask mask);
+    void setParameter(std::size_t index, const std::string& key, const std::string& value);
+};
+
+using ScenePtr = std::shared_ptr<const Scene>;
+
+}  // namespace kb::cfg
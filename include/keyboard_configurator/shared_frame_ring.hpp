@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "keyboard_configurator/key_color_frame.hpp"
+#include "keyboard_configurator/keyboard_model.hpp"
+
+namespace kb::cfg {
+
+// Shared-memory layout of the preview ring, as seen by reader processes.
+// Offsets are from the start of the mapping; all fields are native-endian.
+//
+//   SharedRingHeader
+//   KeyGeometry:    key_count x { float x, y, width, height }  (key units)
+//   present mask:   key_count x u8 (0 for "NAN" layout slots)
+//   slots:          slot_count x slot_stride bytes, each
+//                   SharedRingSlot followed by key_count x {r, g, b}
+//
+// Each slot is a seqlock: the writer makes `seq` odd, writes the slot and
+// makes it even again. Readers take slot (frames_published - 1) % slot_count,
+// copy it, and keep the copy if `seq` was even and unchanged around the copy.
+struct SharedRingHeader {
+    char magic[8];                   // "KBRING1\0"
+    std::uint32_t version;
+    std::uint32_t key_count;
+    std::uint32_t slot_count;
+    std::uint32_t slot_stride;
+    std::uint32_t geometry_offset;
+    std::uint32_t present_offset;
+    std::uint32_t slots_offset;
+    std::uint32_t reserved;
+    std::atomic<std::uint64_t> frames_published;
+};
+
+struct SharedRingSlot {
+    std::atomic<std::uint64_t> seq;
+    std::uint64_t frame_number;      // 1-based
+    std::int64_t timestamp_ns;       // steady clock
+    std::uint64_t reserved;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "the shared ring needs lock-free 64-bit atomics");
+
+// Publishes composed frames to POSIX shared memory for external previewers.
+// publish() is a bounded copy with no locks or syscalls, so it can run on the
+// render thread; readers never block the writer.
+class SharedFrameRing {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+
+    // Creates (or replaces) the shared-memory object `name` (e.g.
+    // "/kb_configurator") sized for `model`. Throws std::runtime_error on
+    // failure. Frames from reactive presets reveal which keys are pressed, so
+    // the ring is private to the user unless a wider `mode` is asked for.
+    SharedFrameRing(const std::string& name, const KeyboardModel& model, std::size_t slots = 4,
+                    std::uint32_t mode = 0600);
+    // Unmaps and unlinks; readers that still map the ring keep their view.
+    ~SharedFrameRing();
+
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+    void publish(const KeyColorFrame& frame);
+
+    [[nodiscard]] const std::string& name() const noexcept { return name_; }
+
+private:
+    std::string name_;
+    void* base_{nullptr};
+    std::size_t size_{0};
+    std::uint32_t key_count_{0};
+    std::uint64_t published_{0};
+};
+
+// Reader side, for in-tree tools and as a reference for other languages.
+class SharedFrameReader {
+public:
+    // Throws std::runtime_error if the ring does not exist or is not valid.
+    explicit SharedFrameReader(const std::string& name);
+    ~SharedFrameReader();
+
+    SharedFrameReader(const SharedFrameReader&) = delete;
+    SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+    [[nodiscard]] std::size_t keyCount() const noexcept;
+    [[nodiscard]] std::vector<KeyRect> rects() const;
+    [[nodiscard]] std::vector<std::uint8_t> presentMask() const;
+
+    // Copies the newest frame; false if none was published yet or the writer
+    // kept overwriting it for every retry. `frame_number` is 1-based.
+    bool readLatest(std::vector<RgbColor>& colors, std::uint64_t& frame_number) const;
+
+private:
+    const void* base_{nullptr};
+    std::size_t size_{0};
+};
+
+}  // namespace kb::cfg
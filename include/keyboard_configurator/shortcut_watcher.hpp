@@ -12,6 +12,7 @@
 struct libevdev;
 
 #include "keyboard_configurator/config_loader.hpp"
+#include "keyboard_configurator/scene.hpp"
 
 namespace kb::cfg {
 
@@ -26,41 +27,53 @@ public:
                     std::size_t key_count);
     ~ShortcutWatcher();
 
+    // Drives the overlay of one more keyboard from the same modifier state;
+    // call before start(). Targets are numbered in the order they are added,
+    // the constructor's being 0.
+    void addTarget(const KeyboardModel& model,
+                   ConfiguratorCLI& cli,
+                   const HyprConfig& hypr,
+                   std::size_t key_count);
+
     void start();
     void stop();
 
     // Called from Hyprland watcher when active window class changes
-    // Returns true if shortcuts are currently ENGAGED (overlay active)
-    bool setActiveClass(const std::string& klass);
+    // Returns true if shortcuts are currently ENGAGED (overlay active) on `target`
+    bool setActiveClass(const std::string& klass, std::size_t target = 0);
 
 private:
-    const KeyboardModel& model_;
-    ConfiguratorCLI& cli_;
-    const HyprConfig hypr_;
-    std::size_t key_count_;
-
-    // Overlay Configuration
-    std::size_t overlay_index_{0};
-    bool overlay_valid_{false};
-
     // Pre-compiled mapping of Shortcuts: [ModifierMask -> [KeyIndices...]]
     struct CompiledProfile {
         std::unordered_map<int, std::vector<std::size_t>> combos;
     };
-    std::unordered_map<std::string, CompiledProfile> compiled_;
+
+    // One keyboard's overlay and the profile state it restores to
+    struct Target {
+        const KeyboardModel* model{nullptr};
+        ConfiguratorCLI* cli{nullptr};
+        HyprConfig hypr;
+        std::size_t key_count{0};
+
+        // Overlay Configuration
+        std::size_t overlay_index{0};
+        bool overlay_valid{false};
+        std::unordered_map<std::string, CompiledProfile> compiled;
+
+        // State
+        std::string active_class;
+        std::string active_shortcut_name;
+        bool engaged{false};
+    };
+    std::vector<Target> targets_;
 
     // Threading
     std::atomic<bool> stop_{false};
     std::thread thread_;
     mutable std::recursive_mutex mutex_;
 
-    // State
-    std::string active_class_;
-    std::string active_shortcut_name_;
-    
     // Modifiers state: 1=CTRL, 2=SHIFT, 4=ALT, 8=SUPER
     std::atomic<int> mods_{0};
-    bool engaged_{false};
 
     // Input Devices
     struct Device {
@@ -75,12 +88,12 @@ private:
     void openDevices();
     void closeDevices();
 
-    void updateActiveShortcutFromClass();
-    void applyMaskForMods(int modmask);
+    void updateActiveShortcutFromClass(Target& target);
+    void applyMaskForMods(Target& target, int modmask);
     
-    // NEW: Restores the background profile based on the active window
+    // Writes the background profile for the active window into `scene`
     // (Used when releasing Ctrl to switch back to the correct "Painter's List")
-    void restoreActiveProfile();
+    static void stageActiveProfile(const Target& target, Scene& scene);
 };
 
 } // namespace kb::cfg
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "keyboard_configurator/device_transport.hpp"
+
+namespace kb::cfg {
+
+// Stand-in for a real keyboard, for load-testing the render and transport
+// pipeline without hardware. Each report blocks for a latency drawn from a
+// log-normal distribution plus its transfer time at a capped byte rate, and
+// stalls, write errors and unplugs are injected at random per report. Every
+// frame is checked against the model given to connect(): payload size,
+// report headers and zero padding; malformed frames fail the write.
+//
+// Like the hardware transports, calls must be serialised. counters(),
+// pluggedIn() and unplug() may be called from any thread.
+class SimulatedTransport : public DeviceTransport {
+public:
+    struct Profile {
+        // Per-report write latency: log-normal with this median and p99
+        std::chrono::microseconds latency{1000};
+        std::chrono::microseconds latency_p99{3000};
+        double bytes_per_second{0.0};               // 0 = unlimited
+        double stall_chance{0.0};                   // per report
+        std::chrono::milliseconds stall{500};       // added to a stalled write
+        double error_chance{0.0};                   // per report; device stays
+        double unplug_chance{0.0};                  // per report
+        std::chrono::milliseconds unplugged{2000};  // until connect() succeeds again
+        std::uint32_t seed{0};                      // 0 = seeded from the clock
+    };
+
+    // What the simulated device saw, for load-test assertions
+    struct Counters {
+        std::uint64_t connects{0};
+        std::uint64_t reports{0};      // written successfully
+        std::uint64_t bytes{0};
+        std::uint64_t malformed{0};    // frames rejected by validation
+        std::uint64_t errors{0};
+        std::uint64_t stalls{0};
+        std::uint64_t unplugs{0};
+    };
+
+    SimulatedTransport() : SimulatedTransport(Profile{}) {}
+    explicit SimulatedTransport(Profile profile);
+
+    std::string id() const override;
+    // Fails while unplugged, like opening an absent device
+    bool connect(const KeyboardModel& model) override;
+    bool sendFrame(const KeyboardModel& model,
+                   const std::vector<std::uint8_t>& payload) override;
+    bool sendReports(const KeyboardModel& model,
+                     const std::vector<std::uint8_t>& payload,
+                     const std::vector<std::uint8_t>& dirty) override;
+    TransportStats transportStats() const override;
+
+    [[nodiscard]] Counters counters() const;
+    [[nodiscard]] bool pluggedIn() const;
+    // Unplugs the device now, for the profile's `unplugged` time
+    void unplug();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    bool send(const std::vector<std::uint8_t>& payload,
+              const std::vector<std::uint8_t>* dirty);
+    bool validate(const std::vector<std::uint8_t>& payload);
+    bool writeReport(std::size_t size);
+    void unplugLocked(Clock::time_point now);
+
+    Profile profile_;
+    std::mt19937 rng_;
+    std::lognormal_distribution<double> latency_us_;
+    std::uniform_real_distribution<double> chance_{0.0, 1.0};
+    std::unique_ptr<KeyboardModel> model_;  // the device's protocol, copied on connect
+
+    // Guards the state below, which other threads read; never held while a
+    // write sleeps.
+    mutable std::mutex mutex_;
+    bool connected_{false};
+    Clock::time_point unplugged_until_{};
+    Counters counters_;
+    std::uint64_t write_failures_{0};
+};
+
+}  // namespace kb::cfg
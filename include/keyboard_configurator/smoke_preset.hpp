@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "keyboard_configurator/preset.hpp"
+#include "keyboard_configurator/color.hpp"
 
 namespace kb::cfg {
 
@@ -13,6 +14,12 @@ public:
     void render(const KeyboardModel& model,
                 double time_seconds,
                 KeyColorFrame& frame) override;
+    void renderVisible(const KeyboardModel& model,
+                       double time_seconds,
+                       KeyColorFrame& frame,
+                       const std::vector<std::size_t>& visible) override;
+    // Noise drifts slowly; interpolated frames are indistinguishable
+    [[nodiscard]] double updateRateHz() const noexcept override { return 20.0; }
     [[nodiscard]] bool isAnimated() const noexcept override { return true; }
     void setKeyActivityProvider(KeyActivityProviderPtr provider) override { provider_ = std::move(provider); }
 
@@ -28,6 +35,7 @@ private:
     double contrast_{1.0};
     RgbColor color_low_{0, 0, 0};
     RgbColor color_high_{255, 180, 80};
+    GradientLut lut_;   // color_low -> color_high
 
     bool reactive_enabled_{false};
     double reactive_history_{1.2};
@@ -38,11 +46,14 @@ private:
     double reactive_push_duration_{0.2};
     bool reactive_push_{false};
 
-    bool coords_built_{false};
-    std::vector<double> xs_;
-    std::vector<double> ys_;
-    void buildCoords(const KeyboardModel& model);
-    void computeReactiveDisplacement(std::vector<double>& dx, std::vector<double>& dy);
+    std::vector<std::size_t> nearby_;  // spatial query scratch
+    void renderKeys(const KeyboardModel& model,
+                    double time_seconds,
+                    KeyColorFrame& frame,
+                    const std::vector<std::size_t>* visible);
+    void computeReactiveDisplacement(const KeyGeometry& geometry,
+                                     std::vector<double>& dx,
+                                     std::vector<double>& dy);
 };
 
 }  // namespace kb::cfg
@@ -27,6 +27,8 @@ public:
     std::string id() const override;
     void configure(const ParameterMap& params) override;
     void render(const KeyboardModel& model, double time_seconds, KeyColorFrame& frame) override;
+    void renderVisible(const KeyboardModel& model, double time_seconds, KeyColorFrame& frame,
+                       const std::vector<std::size_t>& visible) override;
 
     [[nodiscard]] bool isAnimated() const noexcept override { return true; }
     void setKeyActivityProvider(KeyActivityProviderPtr provider) override
@@ -38,8 +40,9 @@ private:
     void reset();
     void cleanupDeadNodes(double now);
     void grow(double now);
-    void applyKeyActivityInjection(double now);
-    void buildCoords(const KeyboardModel& model);
+    void applyKeyActivityInjection(const KeyGeometry& geometry, double now);
+    void renderKeys(const KeyboardModel& model, double time, KeyColorFrame& frame,
+                    const std::vector<std::size_t>* keys);
 
     // Configuration
     int attractor_count_ = 500;
@@ -70,11 +73,6 @@ private:
     double last_growth_time_ = 0.0;
     double internal_time_ = 0.0;
     double last_real_time_ = 0.0;
-
-    // Render Cache
-    std::vector<double> xs_;
-    std::vector<double> ys_;
-    bool coords_built_ = false;
 };
 
 } // namespace kb::cfg
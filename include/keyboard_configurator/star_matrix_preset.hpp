@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "keyboard_configurator/preset.hpp"
+#include "keyboard_configurator/color.hpp"
 
 namespace kb::cfg {
 
@@ -15,6 +16,12 @@ public:
     void render(const KeyboardModel& model,
                 double time_seconds,
                 KeyColorFrame& frame) override;
+    void renderVisible(const KeyboardModel& model,
+                       double time_seconds,
+                       KeyColorFrame& frame,
+                       const std::vector<std::size_t>& visible) override;
+    // Twinkles are slow fades; interpolation covers the frames in between
+    [[nodiscard]] double updateRateHz() const noexcept override { return 10.0; }
     [[nodiscard]] bool isAnimated() const noexcept override { return true; }
 
 private:
@@ -23,7 +30,12 @@ private:
     RgbColor background_{};     // default black
     double density_{0.15};      // fraction of keys twinkling at a time
     double speed_{1.5};         // speed of twinkle cycle
+    GradientLut lut_;           // background -> star
 
+    void renderKeys(const KeyboardModel& model,
+                    double time_seconds,
+                    KeyColorFrame& frame,
+                    const std::vector<std::size_t>* visible);
     static std::uint32_t hash32(std::uint32_t x);
 };
 
@@ -0,0 +1,237 @@
+#include "keyboard_configurator/async_transport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+
+#include "keyboard_configurator/keyboard_model.hpp"
+
+namespace kb::cfg {
+
+namespace {
+
+constexpr std::size_t kLatencyWindow = 1024;
+
+using Clock = std::chrono::steady_clock;
+
+double toMs(Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+}  // namespace
+
+struct AsyncTransport::State {
+    std::unique_ptr<DeviceTransport> inner;
+    // Private copy for the writer, taken on connect or the first send
+    std::unique_ptr<KeyboardModel> model;
+    std::chrono::milliseconds timeout;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::uint8_t> pending;
+    std::vector<std::uint8_t> pending_dirty;
+    bool pending_all{false};
+    bool has_pending{false};
+    bool resync{false};      // a write failed; the next one sends every report
+    bool failed{false};      // not yet reported to the caller
+    bool stop{false};
+    bool finished{false};
+
+    bool writing{false};
+    Clock::time_point write_started{};
+    bool stalled{false};
+
+    TransportStats counters;
+    std::array<double, kLatencyWindow> latency_ms{};
+    std::size_t latency_count{0};
+    std::size_t latency_next{0};
+
+    // Expects mutex held
+    void checkStall(Clock::time_point now) {
+        if (!writing || stalled || timeout.count() <= 0 || now - write_started <= timeout) {
+            return;
+        }
+        stalled = true;
+        ++counters.write_stalls;
+        std::cerr << "[AsyncTransport] " << inner->id() << " write stalled for over "
+                  << timeout.count() << " ms" << '\n';
+    }
+};
+
+AsyncTransport::AsyncTransport(std::unique_ptr<DeviceTransport> inner,
+                               std::chrono::milliseconds write_timeout)
+    : state_(std::make_shared<State>()) {
+    state_->inner = std::move(inner);
+    state_->timeout = write_timeout;
+    writer_ = std::thread(&AsyncTransport::writerLoop, state_);
+}
+
+AsyncTransport::~AsyncTransport() {
+    auto& s = *state_;
+    std::unique_lock<std::mutex> lock(s.mutex);
+    s.stop = true;
+    s.cv.notify_all();
+    bool done = true;
+    if (s.timeout.count() > 0) {
+        // One write for the pending frame plus one already in flight
+        done = s.cv.wait_for(lock, s.timeout * 2, [&s] { return s.finished; });
+    } else {
+        s.cv.wait(lock, [&s] { return s.finished; });
+    }
+    lock.unlock();
+    if (done) {
+        writer_.join();
+    } else {
+        std::cerr << "[AsyncTransport] " << s.inner->id()
+                  << " writer did not finish, abandoning it" << '\n';
+        writer_.detach();
+    }
+}
+
+std::string AsyncTransport::id() const {
+    return state_->inner->id();
+}
+
+bool AsyncTransport::connect(const KeyboardModel& model) {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->model) {
+            state_->model = std::make_unique<KeyboardModel>(model);
+        }
+    }
+    return state_->inner->connect(model);
+}
+
+bool AsyncTransport::sendFrame(const KeyboardModel& model,
+                               const std::vector<std::uint8_t>& payload) {
+    return enqueue(model, payload, nullptr);
+}
+
+bool AsyncTransport::sendReports(const KeyboardModel& model,
+                                 const std::vector<std::uint8_t>& payload,
+                                 const std::vector<std::uint8_t>& dirty) {
+    return enqueue(model, payload, &dirty);
+}
+
+bool AsyncTransport::enqueue(const KeyboardModel& model,
+                             const std::vector<std::uint8_t>& payload,
+                             const std::vector<std::uint8_t>* dirty) {
+    auto& s = *state_;
+    bool healthy = true;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.model) {
+            s.model = std::make_unique<KeyboardModel>(model);
+        }
+        s.checkStall(Clock::now());
+
+        // A replaced frame's reports must still reach the device, so the
+        // dirty sets are merged rather than overwritten.
+        bool all = dirty == nullptr || s.resync;
+        if (s.has_pending) {
+            ++s.counters.frames_coalesced;
+            all = all || s.pending_all || s.pending_dirty.size() != dirty->size();
+            if (!all) {
+                for (std::size_t r = 0; r < dirty->size(); ++r) {
+                    s.pending_dirty[r] |= (*dirty)[r];
+                }
+            }
+        } else if (!all) {
+            s.pending_dirty.assign(dirty->begin(), dirty->end());
+        }
+        s.pending_all = all;
+        s.resync = false;
+        s.pending.assign(payload.begin(), payload.end());
+        s.has_pending = true;
+
+        healthy = !s.failed && !s.stalled;
+        s.failed = false;
+    }
+    s.cv.notify_all();
+    return healthy;
+}
+
+void AsyncTransport::writerLoop(std::shared_ptr<State> state) {
+    auto& s = *state;
+    std::vector<std::uint8_t> payload;
+    std::vector<std::uint8_t> dirty;
+    std::unique_lock<std::mutex> lock(s.mutex);
+    while (true) {
+        s.cv.wait(lock, [&s] { return s.has_pending || s.stop; });
+        if (!s.has_pending) {
+            break;
+        }
+        payload.swap(s.pending);
+        dirty.swap(s.pending_dirty);
+        const bool all = s.pending_all;
+        s.has_pending = false;
+        s.pending_all = false;
+        s.writing = true;
+        const auto start = Clock::now();
+        s.write_started = start;
+        lock.unlock();
+
+        const bool ok = all ? s.inner->sendFrame(*s.model, payload)
+                            : s.inner->sendReports(*s.model, payload, dirty);
+        const auto elapsed = Clock::now() - start;
+
+        lock.lock();
+        s.writing = false;
+        if (s.stalled) {
+            s.stalled = false;
+            std::cerr << "[AsyncTransport] " << s.inner->id() << " write returned after "
+                      << toMs(elapsed) << " ms" << '\n';
+        }
+        const double ms = toMs(elapsed);
+        s.latency_ms[s.latency_next] = ms;
+        s.latency_next = (s.latency_next + 1) % kLatencyWindow;
+        s.latency_count = std::min(s.latency_count + 1, kLatencyWindow);
+        s.counters.latency_max_ms = std::max(s.counters.latency_max_ms, ms);
+        if (ok) {
+            ++s.counters.writes;
+        } else {
+            ++s.counters.write_failures;
+            s.failed = true;
+            s.resync = true;
+            if (s.has_pending) {
+                s.pending_all = true;
+            }
+        }
+    }
+    s.finished = true;
+    s.cv.notify_all();
+}
+
+TransportStats AsyncTransport::transportStats() const {
+    std::vector<double> window;
+    // Connection state comes from further down the chain
+    TransportStats stats = state_->inner->transportStats();
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->checkStall(Clock::now());
+        const auto& own = state_->counters;
+        stats.writes = own.writes;
+        stats.write_failures = own.write_failures;
+        stats.frames_coalesced = own.frames_coalesced;
+        stats.write_stalls = own.write_stalls;
+        stats.latency_max_ms = own.latency_max_ms;
+        window.assign(state_->latency_ms.begin(),
+                      state_->latency_ms.begin() + static_cast<std::ptrdiff_t>(state_->latency_count));
+    }
+    if (window.empty()) {
+        return stats;
+    }
+    auto percentile = [&window](double p) {
+        const auto rank = static_cast<std::size_t>(p * static_cast<double>(window.size() - 1) + 0.5);
+        std::nth_element(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(rank), window.end());
+        return window[rank];
+    };
+    stats.latency_p50_ms = percentile(0.50);
+    stats.latency_p95_ms = percentile(0.95);
+    stats.latency_p99_ms = percentile(0.99);
+    return stats;
+}
+
+}  // namespace kb::cfg
@@ -0,0 +1,122 @@
+#include "keyboard_configurator/color.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace kb::cfg {
+
+namespace {
+int hexValue(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return 10 + (ch - 'a');
+    if (ch >= 'A' && ch <= 'F') return 10 + (ch - 'A');
+    return -1;
+}
+
+inline std::uint8_t toByte(float x) {
+    x = x * 255.0f + 0.5f;
+    return static_cast<std::uint8_t>(x > 0.0f ? (x < 255.0f ? x : 255.0f) : 0.0f);
+}
+}  // namespace
+
+std::optional<RgbColor> tryParseHexColor(const std::string& value) {
+    if (value.size() != 7 || value.front() != '#') {
+        return std::nullopt;
+    }
+    std::uint8_t channels[3];
+    for (std::size_t c = 0; c < 3; ++c) {
+        const int hi = hexValue(value[1 + c * 2]);
+        const int lo = hexValue(value[2 + c * 2]);
+        if (hi < 0 || lo < 0) {
+            return std::nullopt;
+        }
+        channels[c] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return RgbColor{channels[0], channels[1], channels[2]};
+}
+
+RgbColor parseHexColor(const std::string& value, RgbColor fallback) {
+    return tryParseHexColor(value).value_or(fallback);
+}
+
+std::uint8_t mix8(std::uint8_t a, std::uint8_t b, double t) {
+    t = std::clamp(t, 0.0, 1.0);
+    return static_cast<std::uint8_t>(std::clamp<long>(std::lround(a + (b - a) * t), 0, 255));
+}
+
+RgbColor mixColor(RgbColor a, RgbColor b, double t) {
+    return {mix8(a.r, b.r, t), mix8(a.g, b.g, t), mix8(a.b, b.b, t)};
+}
+
+RgbColor hsvToRgb(double hue_degrees, double s, double v) {
+    double h = std::fmod(hue_degrees, 360.0);
+    if (h < 0.0) h += 360.0;
+    const float hue = static_cast<float>(h);
+    RgbColor out;
+    hsvToRgb(&hue, static_cast<float>(s), static_cast<float>(v), &out, 1);
+    return out;
+}
+
+void hsvToRgb(const float* hue_degrees, float s, float v, RgbColor* out, std::size_t count) {
+    s = std::clamp(s, 0.0f, 1.0f);
+    v = std::clamp(v, 0.0f, 1.0f);
+    const float vs = v * s;
+    // channel = v - v*s * clamp(min(k, 4 - k), 0, 1), k = (n + h/60) mod 6
+    auto channel = [vs, v](float h6, float n) {
+        float k = n + h6;
+        k -= 6.0f * std::floor(k * (1.0f / 6.0f));
+        const float ramp = std::clamp(std::min(k, 4.0f - k), 0.0f, 1.0f);
+        return v - vs * ramp;
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        const float h6 = hue_degrees[i] * (1.0f / 60.0f);
+        out[i] = {toByte(channel(h6, 5.0f)), toByte(channel(h6, 3.0f)), toByte(channel(h6, 1.0f))};
+    }
+}
+
+GradientLut GradientLut::fromStops(const std::vector<RgbColor>& stops, bool nearest, std::size_t size) {
+    GradientLut lut;
+    if (stops.empty() || size == 0) {
+        return lut;
+    }
+    size = std::max<std::size_t>(size, 2);
+    lut.table_.resize(size);
+    lut.scale_ = static_cast<double>(size - 1);
+    const std::size_t last = stops.size() - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+        const double pos = static_cast<double>(i) / lut.scale_ * static_cast<double>(last);
+        if (last == 0 || nearest) {
+            lut.table_[i] = stops[std::min<std::size_t>(static_cast<std::size_t>(std::lround(pos)), last)];
+            continue;
+        }
+        const std::size_t i0 = std::min<std::size_t>(static_cast<std::size_t>(pos), last);
+        const std::size_t i1 = std::min(i0 + 1, last);
+        lut.table_[i] = mixColor(stops[i0], stops[i1], pos - static_cast<double>(i0));
+    }
+    return lut;
+}
+
+GradientLut GradientLut::hueWheel(double s, double v, std::size_t size) {
+    GradientLut lut;
+    size = std::max<std::size_t>(size, 2);
+    std::vector<float> hues(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        hues[i] = 360.0f * static_cast<float>(i) / static_cast<float>(size - 1);
+    }
+    lut.table_.resize(size);
+    lut.scale_ = static_cast<double>(size - 1);
+    hsvToRgb(hues.data(), static_cast<float>(s), static_cast<float>(v), lut.table_.data(), size);
+    return lut;
+}
+
+RgbColor GradientLut::wrapped(double t) const noexcept {
+    return at(t - std::floor(t));
+}
+
+void GradientLut::tint(RgbColor tint, double amount) {
+    for (auto& entry : table_) {
+        entry = mixColor(entry, tint, amount);
+    }
+}
+
+}  // namespace kb::cfg
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -20,8 +21,13 @@
 // Required for keycode parsing
 #include <libevdev/libevdev.h>
 
+#include "keyboard_configurator/async_transport.hpp"
 #include "keyboard_configurator/hidapi_transport.hpp"
+#include "keyboard_configurator/hidraw_transport.hpp"
 #include "keyboard_configurator/logging_transport.hpp"
+#include "keyboard_configurator/reconnecting_transport.hpp"
+#include "keyboard_configurator/recording_transport.hpp"
+#include "keyboard_configurator/simulated_transport.hpp"
 
 namespace kb::cfg {
 
@@ -120,6 +126,49 @@ int parseKeycodeToken(const std::string& raw) {
     }
 }
 
+// label,x,y[,width[,height]] in key units (x/y = top-left corner). Keys not
+// listed keep their layout-grid position.
+std::vector<KeyRect> readGeometryCsv(const std::filesystem::path& path,
+                                     const KeyboardModel& model) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Failed to open geometry file: " + path.string());
+
+    std::vector<KeyRect> rects = model.geometry().rects();
+    std::string line;
+    std::size_t line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::istringstream line_stream(line);
+        std::string token;
+        while (std::getline(line_stream, token, ',')) {
+            fields.push_back(trim(token));
+        }
+        if (fields.size() < 3) {
+            throw std::runtime_error("Geometry line " + std::to_string(line_no) + " needs label,x,y");
+        }
+        auto index = model.indexForKey(fields[0]);
+        if (!index) {
+            std::cerr << "Warning: Geometry for unknown key '" << fields[0] << "' ignored.\n";
+            continue;
+        }
+        try {
+            KeyRect rect;
+            rect.x = std::stod(fields[1]);
+            rect.y = std::stod(fields[2]);
+            if (fields.size() > 3) rect.width = std::stod(fields[3]);
+            if (fields.size() > 4) rect.height = std::stod(fields[4]);
+            rects[*index] = rect;
+        } catch (const std::exception&) {
+            throw std::runtime_error("Geometry line " + std::to_string(line_no) + " has a bad number");
+        }
+    }
+    return rects;
+}
+
 std::vector<int> readKeycodeCsv(const std::filesystem::path& path,
                                 const KeyboardModel::Layout& layout) {
     std::ifstream in(path);
@@ -149,11 +198,47 @@ std::vector<int> readKeycodeCsv(const std::filesystem::path& path,
     return out;
 }
 
-// --- Helper: Transport Factory ---
-std::unique_ptr<DeviceTransport> createTransport(const std::string& id) {
-    if (id == "logging") return std::make_unique<LoggingTransport>();
-    if (id == "hidapi") return std::make_unique<HidapiTransport>();
-    throw std::runtime_error("Unsupported transport: " + id);
+// --- Helper: Mask Feathering ---
+// Grows `mask` by `radius` layout cells and returns the per-key alpha that
+// fades linearly from the original zone edge.
+std::vector<std::uint8_t> featherMask(const KeyboardModel& model,
+                                      KeyMask& mask,
+                                      double radius) {
+    const auto key_count = model.keyCount();
+    std::vector<double> rows(key_count, 0.0);
+    std::vector<double> cols(key_count, 0.0);
+    std::size_t idx = 0;
+    const auto& layout = model.layout();
+    for (std::size_t r = 0; r < layout.size(); ++r) {
+        for (std::size_t c = 0; c < layout[r].size(); ++c) {
+            rows[idx] = static_cast<double>(r);
+            cols[idx] = static_cast<double>(c);
+            ++idx;
+        }
+    }
+
+    const std::vector<std::size_t> inside = mask.indices();
+
+    std::vector<std::uint8_t> alpha(key_count, 0);
+    const auto& labels = model.keyLabels();
+    for (std::size_t k = 0; k < key_count; ++k) {
+        if (mask.test(k)) {
+            alpha[k] = 255;
+            continue;
+        }
+        if (labels[k] == "NAN") continue;
+        double best = radius + 1.0;
+        for (auto in : inside) {
+            const double dr = rows[k] - rows[in];
+            const double dc = cols[k] - cols[in];
+            best = std::min(best, std::sqrt(dr * dr + dc * dc));
+        }
+        if (best <= radius) {
+            alpha[k] = static_cast<std::uint8_t>(std::lround(255.0 * (1.0 - best / (radius + 1.0))));
+            mask.set(k);
+        }
+    }
+    return alpha;
 }
 
 // --- Helper: Parse Modifiers ---
@@ -174,22 +259,75 @@ int parseModifierMask(const std::string& key) {
 
 } // namespace
 
-ConfigLoader::ConfigLoader(const PresetRegistry& registry) : registry_(registry) {}
+std::unique_ptr<DeviceTransport> createTransport(const std::string& id) {
+    if (id == "logging") return std::make_unique<LoggingTransport>();
+    if (id == "hidapi") return std::make_unique<HidapiTransport>();
+    if (id == "hidraw") return std::make_unique<HidrawTransport>();
+    if (id == "simulated") return std::make_unique<SimulatedTransport>();
+    throw std::runtime_error("Unsupported transport: " + id);
+}
 
-RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
-    const auto file_path = std::filesystem::absolute(path);
-    const auto root_dir = file_path.parent_path();
+namespace {
 
-    toml::table tbl;
+toml::table parseConfigFile(const std::string& path) {
     try {
-        tbl = toml::parse_file(path);
+        return toml::parse_file(path);
     } catch (const toml::parse_error& err) {
         throw std::runtime_error("TOML Parse Error: " + std::string(err.description()));
     }
+}
 
-    auto device = tbl["device"];
-    if (!device) throw std::runtime_error("Missing [device] section");
+// The [[devices]] entries, each on top of [device] so keys shared by every
+// keyboard can stay there; just [device] when there is no [[devices]] array.
+std::vector<toml::table> deviceTables(const toml::table& tbl) {
+    const toml::table* base = tbl["device"].as_table();
+    std::vector<toml::table> tables;
+    if (auto arr = tbl["devices"].as_array()) {
+        for (auto& node : *arr) {
+            auto entry = node.as_table();
+            if (!entry) continue;
+            toml::table merged = base ? *base : toml::table{};
+            for (auto& [key, value] : *entry) {
+                merged.insert_or_assign(key, value);
+            }
+            tables.push_back(std::move(merged));
+        }
+        if (tables.empty()) throw std::runtime_error("[[devices]] has no device tables");
+    } else if (base) {
+        tables.push_back(*base);
+    } else {
+        throw std::runtime_error("Missing [device] section");
+    }
+    return tables;
+}
 
+// [device.simulated]: latencies in ms, chances per report in 0..1
+SimulatedTransport::Profile readSimulatedProfile(const toml::table* tbl) {
+    SimulatedTransport::Profile profile;
+    if (!tbl) return profile;
+    auto ms = [](double value) {
+        return std::chrono::microseconds(std::llround(std::max(0.0, value) * 1000.0));
+    };
+    auto chance = [](double value) { return std::clamp(value, 0.0, 1.0); };
+    const double latency_ms = (*tbl)["latency_ms"].value_or(1.0);
+    profile.latency = ms(latency_ms);
+    profile.latency_p99 = ms((*tbl)["latency_p99_ms"].value_or(latency_ms * 3.0));
+    profile.bytes_per_second = std::max(0.0, (*tbl)["bytes_per_second"].value_or(0.0));
+    profile.stall_chance = chance((*tbl)["stall_chance"].value_or(0.0));
+    profile.stall = std::chrono::milliseconds(std::max<int64_t>(0, (*tbl)["stall_ms"].value_or(500)));
+    profile.error_chance = chance((*tbl)["error_chance"].value_or(0.0));
+    profile.unplug_chance = chance((*tbl)["unplug_chance"].value_or(0.0));
+    profile.unplugged = std::chrono::milliseconds(std::max<int64_t>(0, (*tbl)["unplugged_ms"].value_or(2000)));
+    profile.seed = static_cast<std::uint32_t>((*tbl)["seed"].value_or(0));
+    return profile;
+}
+
+// Builds one keyboard's runtime from its device table and the shared preset,
+// profile and shortcut sections of `tbl`.
+RuntimeConfig loadDevice(const PresetRegistry& registry,
+                         const toml::table& tbl,
+                         const toml::table& device,
+                         const std::filesystem::path& root_dir) {
     std::string name = device["name"].value_or("Unknown Device");
     uint16_t vid = device["vendor_id"].value_or(0);
     uint16_t pid = device["product_id"].value_or(0);
@@ -201,27 +339,142 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
 
     size_t pkt_len = device["packet_length"].value_or(0);
     uint32_t fps = device["frame_interval_ms"].value_or(33);
+    int64_t keepalive_ms = device["keepalive_ms"].value_or(1000);
+    int64_t render_threads = device["render_threads"].value_or(0);
+    int64_t idle_timeout_ms = device["idle_timeout_ms"].value_or(300000);
+    int64_t idle_interval_ms = device["idle_interval_ms"].value_or(1000);
+    std::string overrun_name = device["frame_overrun"].value_or("skip");
+    auto overrun_policy = parseOverrunPolicy(overrun_name);
+    if (!overrun_policy) {
+        std::cerr << "Warning: Unknown frame_overrun '" << overrun_name << "', using 'skip'.\n";
+    }
     std::string transport = device["transport"].value_or("hidapi");
+    bool reconnect = device["reconnect"].value_or(true);
+    int64_t reconnect_initial_ms = device["reconnect_initial_ms"].value_or(500);
+    int64_t reconnect_max_ms = device["reconnect_max_ms"].value_or(30000);
+    bool async_writes = device["async_writes"].value_or(false);
+    std::string record_file = device["record"].value_or("");
+    int64_t write_timeout_ms = device["write_timeout_ms"].value_or(250);
+
+    OutputSettings output;
+    output.brightness = device["brightness"].value_or(1.0);
+    output.gamma = device["gamma"].value_or(1.0);
+    output.dither = device["dither"].value_or(false);
+    output.linear_blend = device["linear_blend"].value_or(false);
+    if (auto arr = device["white_balance"].as_array()) {
+        std::vector<float> values;
+        for (auto& v : *arr) values.push_back(static_cast<float>(v.value_or(0.0)));
+        // Three per-channel gains or a row-major 3x3 matrix
+        if (values.size() == 3) {
+            for (std::size_t c = 0; c < 3; ++c) output.white_balance[c * 4] = values[c];
+        } else if (values.size() == 9) {
+            std::copy(values.begin(), values.end(), output.white_balance.begin());
+        } else {
+            std::cerr << "Warning: white_balance needs 3 gains or 9 matrix entries, ignoring.\n";
+        }
+    }
     
     std::filesystem::path layout_path = root_dir / device["layout"].value_or("");
     std::filesystem::path keycodes_path = root_dir / device["keycodes"].value_or("");
+    std::string geometry_file = device["geometry"].value_or("");
 
     // Load Helpers
     auto layout = readLayout(layout_path); 
     
     RuntimeConfig config{
         KeyboardModel(name, vid, pid, header, pkt_len, layout, std::nullopt, std::nullopt),
-        createTransport(transport),
+        // "record" captures frames without a device (see `record` below)
+        transport == "record" ? nullptr
+            : transport == "simulated"
+                ? std::make_unique<SimulatedTransport>(readSimulatedProfile(device["simulated"].as_table()))
+                : createTransport(transport),
         {}, {},
         std::chrono::milliseconds(fps),
+        std::chrono::milliseconds(std::max<int64_t>(0, keepalive_ms)),
+        static_cast<std::size_t>(std::clamp<int64_t>(render_threads, 0, 16)),
+        overrun_policy.value_or(OverrunPolicy::Skip),
+        IdlePolicy{std::chrono::milliseconds(std::max<int64_t>(0, idle_timeout_ms)),
+                   std::chrono::milliseconds(std::max<int64_t>(0, idle_interval_ms))},
+        output,
         std::nullopt, std::nullopt,
-        {}, {}
+        {}, {}, {}, {}, {}
     };
 
+    // Decorators, innermost first: reconnect below the writer thread so
+    // reconnect attempts never run on the render path.
+    if (config.transport && reconnect) {
+        ReconnectingTransport::Backoff backoff;
+        backoff.initial = std::chrono::milliseconds(std::max<int64_t>(1, reconnect_initial_ms));
+        backoff.max = std::chrono::milliseconds(std::max<int64_t>(1, reconnect_max_ms));
+        config.transport = std::make_unique<ReconnectingTransport>(std::move(config.transport), backoff);
+    }
+    if (config.transport && async_writes) {
+        config.transport = std::make_unique<AsyncTransport>(
+            std::move(config.transport),
+            std::chrono::milliseconds(std::max<int64_t>(0, write_timeout_ms)));
+        config.async_writes = true;
+    }
+
+    // Outermost, so frames are captured even while the device is away
+    if (!record_file.empty()) {
+        config.transport = std::make_unique<RecordingTransport>(std::move(config.transport),
+                                                                root_dir / record_file);
+    } else if (!config.transport) {
+        throw std::runtime_error("transport = \"record\" needs a record file");
+    }
+
+    config.preview_ring = device["preview_ring"].value_or("");
+    config.preview_slots = static_cast<std::size_t>(
+        std::clamp<int64_t>(device["preview_slots"].value_or(4), 2, 64));
+
     if (std::filesystem::exists(keycodes_path)) {
          config.model.setKeycodeMap(readKeycodeCsv(keycodes_path, layout));
     }
 
+    if (!geometry_file.empty()) {
+        config.model.setKeyGeometry(readGeometryCsv(root_dir / geometry_file, config.model));
+    }
+
+    // Wire protocol: channel order and an optional split into several reports
+    std::string channel_order = device["channel_order"].value_or("RGB");
+    if (auto order = parseChannelOrder(channel_order)) {
+        config.model.setChannelOrder(*order);
+    } else {
+        std::cerr << "Warning: Unknown channel_order '" << channel_order << "', using 'RGB'.\n";
+    }
+    if (auto chunks_arr = device["chunks"].as_array()) {
+        std::vector<KeyboardModel::ReportChunk> chunks;
+        std::size_t next_key = 0;
+        for (auto& node : *chunks_arr) {
+            auto chunk_tbl = node.as_table();
+            if (!chunk_tbl) continue;
+            KeyboardModel::ReportChunk chunk;
+            if (auto arr = (*chunk_tbl)["header"].as_array()) {
+                for (auto& byte : *arr) chunk.header.push_back(static_cast<uint8_t>(byte.value_or(0)));
+            }
+            const int64_t first_key = (*chunk_tbl)["first_key"].value_or(static_cast<int64_t>(next_key));
+            if (first_key < 0) {
+                throw std::runtime_error("Invalid [[device.chunks]]: first_key must not be negative");
+            }
+            chunk.first_key = static_cast<std::size_t>(first_key);
+            // Default: as many keys as fit after the header
+            const std::size_t room = pkt_len > chunk.header.size() ? (pkt_len - chunk.header.size()) / 3 : 0;
+            const std::size_t remaining = config.model.keyCount() > chunk.first_key ? config.model.keyCount() - chunk.first_key : 0;
+            const int64_t keys = (*chunk_tbl)["keys"].value_or(static_cast<int64_t>(std::min(room, remaining)));
+            if (keys < 0) {
+                throw std::runtime_error("Invalid [[device.chunks]]: keys must not be negative");
+            }
+            chunk.key_count = static_cast<std::size_t>(keys);
+            next_key = chunk.first_key + chunk.key_count;
+            chunks.push_back(std::move(chunk));
+        }
+        try {
+            config.model.setReportChunks(std::move(chunks));
+        } catch (const std::invalid_argument& err) {
+            throw std::runtime_error(std::string("Invalid [[device.chunks]]: ") + err.what());
+        }
+    }
+
     const std::size_t key_count = config.model.keyCount();
 
     // Load Zones
@@ -236,7 +489,7 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
 
     auto createPreset = [&](const std::string& type,
                             ParameterMap params) -> std::optional<std::size_t> {
-        auto preset = registry_.create(type);
+        auto preset = registry.create(type);
         if (!preset) {
             std::cerr << "Warning: Unknown preset type '" << type << "'.\n";
             return std::nullopt;
@@ -246,6 +499,9 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
         config.preset_parameters.push_back(std::move(params));
         config.preset_masks.emplace_back(key_count, true);
         config.preset_enabled.push_back(false);
+        config.preset_blend.emplace_back();
+        config.preset_alpha.emplace_back();
+        config.preset_update_hz.push_back(0.0);
         return config.presets.size() - 1;
     };
 
@@ -253,11 +509,13 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
     if (auto hypr_node = tbl["hypr"]) {
         HyprConfig hcfg;
         hcfg.enabled = hypr_node["enabled"].value_or(false);
+        // Built here, then frozen into hcfg.profile_masks once every preset exists
+        std::unordered_map<std::string, std::vector<KeyMask>> profile_mask_sets;
         
         auto growProfileMasks = [&](std::size_t idx) {
-            for (auto& [_, masks] : hcfg.profile_masks) {
+            for (auto& [_, masks] : profile_mask_sets) {
                 if (masks.size() <= idx) {
-                    masks.resize(idx + 1, std::vector<bool>(key_count, true));
+                    masks.resize(idx + 1, KeyMask(key_count, true));
                 }
             }
         };
@@ -305,7 +563,7 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
             for (auto& [prof_name, prof_node] : *profiles) {
                 std::string profile_id(prof_name.str());
                 auto& draw_order = hcfg.profile_draw_order[profile_id];
-                auto& profile_masks = hcfg.profile_masks[profile_id];
+                auto& profile_masks = profile_mask_sets[profile_id];
 
                 auto applyZoneMask = [&](std::size_t target_idx, const toml::array& zones) {
                     for (auto& zn : zones) {
@@ -314,7 +572,7 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
                         if (zit == zone_map.end()) continue;
                         for (const auto& klabel : zit->second) {
                             if (auto idx = config.model.indexForKey(klabel)) {
-                                profile_masks[target_idx][*idx] = true;
+                                profile_masks[target_idx].set(*idx);
                             }
                         }
                     }
@@ -323,7 +581,7 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
                 auto applyKeyMask = [&](std::size_t target_idx, const toml::array& keys) {
                     for (auto& kn : keys) {
                         if (auto idx = config.model.indexForKey(kn.value_or(""))) {
-                            profile_masks[target_idx][*idx] = true;
+                            profile_masks[target_idx].set(*idx);
                         }
                     }
                 };
@@ -350,7 +608,9 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
                     for (auto& [ekey, eval] : *effect_tbl) {
                         std::string key = std::string(ekey.str());
                         if (key == "type" || key == "name") continue;
-                        if (effect_is_layer && (key == "zones" || key == "keys" || key == "effect")) {
+                        if (effect_is_layer && (key == "zones" || key == "keys" || key == "effect" ||
+                                                key == "blend" || key == "opacity" || key == "feather" ||
+                                                key == "update_hz")) {
                             continue;
                         }
                         params[key] = tomlToString(eval);
@@ -380,7 +640,7 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
                             draw_order.push_back(preset_idx);
 
                             if (profile_masks.size() <= preset_idx) {
-                                profile_masks.resize(preset_idx + 1, std::vector<bool>(key_count, true));
+                                profile_masks.resize(preset_idx + 1, KeyMask(key_count, true));
                             }
 
                             auto& mask = profile_masks[preset_idx];
@@ -390,7 +650,7 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
                             bool has_keys = layer_tbl->contains("keys");
 
                             if (has_zones || has_keys) {
-                                std::fill(mask.begin(), mask.end(), false);
+                                mask.fill(false);
 
                                 if (has_zones) {
                                     if (auto zones = layer_tbl->get("zones")) {
@@ -408,6 +668,31 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
                                     }
                                 }
                             }
+
+                            // Compositing: blend mode, opacity and feathered zone edges
+                            if (auto blend_node = layer_tbl->get("blend")) {
+                                std::string blend_name = blend_node->value_or(std::string{});
+                                if (auto mode = parseBlendMode(blend_name)) {
+                                    config.preset_blend[preset_idx].mode = *mode;
+                                } else {
+                                    std::cerr << "Warning: Profile '" << profile_id << "' has unknown blend mode '"
+                                              << blend_name << "'.\n";
+                                }
+                            }
+                            if (auto opacity_node = layer_tbl->get("opacity")) {
+                                const double opacity = std::clamp(opacity_node->value_or(1.0), 0.0, 1.0);
+                                config.preset_blend[preset_idx].opacity =
+                                    static_cast<std::uint8_t>(std::lround(opacity * 255.0));
+                            }
+                            if (auto feather_node = layer_tbl->get("feather")) {
+                                const double feather = feather_node->value_or(0.0);
+                                if (feather > 0.0) {
+                                    config.preset_alpha[preset_idx] = featherMask(config.model, mask, feather);
+                                }
+                            }
+                            if (auto rate_node = layer_tbl->get("update_hz")) {
+                                config.preset_update_hz[preset_idx] = std::max(0.0, rate_node->value_or(0.0));
+                            }
                         }
                     }
                 }
@@ -439,10 +724,57 @@ RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
             }
         }
 
+        for (auto& [profile_id, masks] : profile_mask_sets) {
+            masks.resize(config.presets.size(), KeyMask(key_count, true));
+            hcfg.profile_masks[profile_id] = std::make_shared<const MaskSet>(std::move(masks));
+        }
+
         config.hypr = std::move(hcfg);
     }
 
     return config;
 }
 
+} // namespace
+
+ConfigLoader::ConfigLoader(const PresetRegistry& registry) : registry_(registry) {}
+
+RuntimeConfig ConfigLoader::loadFromFile(const std::string& path) const {
+    const auto root_dir = std::filesystem::absolute(path).parent_path();
+    const auto tbl = parseConfigFile(path);
+    return loadDevice(registry_, tbl, deviceTables(tbl).front(), root_dir);
+}
+
+std::vector<RuntimeConfig> ConfigLoader::loadDevicesFromFile(const std::string& path) const {
+    const auto root_dir = std::filesystem::absolute(path).parent_path();
+    const auto tbl = parseConfigFile(path);
+    const auto tables = deviceTables(tbl);
+
+    std::vector<RuntimeConfig> configs;
+    configs.reserve(tables.size());
+    std::vector<std::string> rings;
+    std::vector<std::string> records;
+    for (std::size_t i = 0; i < tables.size(); ++i) {
+        const std::string where = tables.size() > 1 ? "Device " + std::to_string(i) + ": " : "";
+        // A second ring or capture of the same name would replace the first
+        const std::string ring = tables[i]["preview_ring"].value_or("");
+        const std::string record = tables[i]["record"].value_or("");
+        if (!ring.empty() && std::find(rings.begin(), rings.end(), ring) != rings.end()) {
+            throw std::runtime_error(where + "preview_ring '" + ring + "' is already used by another device");
+        }
+        if (!record.empty() && std::find(records.begin(), records.end(), record) != records.end()) {
+            throw std::runtime_error(where + "record file '" + record + "' is already used by another device");
+        }
+        rings.push_back(ring);
+        records.push_back(record);
+
+        try {
+            configs.push_back(loadDevice(registry_, tbl, tables[i], root_dir));
+        } catch (const std::runtime_error& err) {
+            throw std::runtime_error(where + err.what());
+        }
+    }
+    return configs;
+}
+
 } // namespace kb::cfg
\ No newline at end of file
@@ -18,12 +18,21 @@ ConfiguratorCLI::ConfiguratorCLI(const KeyboardModel& model,
                                  std::chrono::milliseconds frame_interval)
     : model_(model),
       engine_(engine),
-      preset_parameters_(std::move(preset_parameters)),
+      preset_count_(engine.presetCount()),
+      applied_parameters_(preset_parameters),
       stop_flag_(false),
       frame_interval_ms_(std::max(1, static_cast<int>(frame_interval.count()))),
       loop_running_(false),
+      scheduler_(frame_interval),
       config_watch_enabled_(false),
-      config_changed_(false) {}
+      config_changed_(false) {
+    // The engine's presets were configured from these parameters at load time,
+    // so the initial scene matches what is already applied.
+    auto initial = std::make_shared<Scene>();
+    initial->parameters = std::move(preset_parameters);
+    scene_ = std::move(initial);
+    engine_.setFrameInterval(std::chrono::milliseconds(frame_interval_ms_.load()));
+}
 
 ConfiguratorCLI::~ConfiguratorCLI() {
     stopConfigWatch();
@@ -44,10 +53,13 @@ void ConfiguratorCLI::printHelp() const {
               << "  frame <ms>              - set frame interval for animated presets" << '\n'
               << "  snake <start|stop>      - start or stop snake game" << '\n'
               << "  watch <on|off>          - enable/disable config file watching" << '\n'
+              << "  stats                    - show render statistics" << '\n'
               << "  quit                     - exit" << '\n';
 }
 
 void ConfiguratorCLI::printPresets() {
+    const auto current = scene();
+    const auto& parameters = current->parameters;
     std::lock_guard<std::mutex> guard(engine_mutex_);
     const auto count = engine_.presetCount();
     std::cout << "Presets:" << '\n';
@@ -62,10 +74,10 @@ void ConfiguratorCLI::printPresets() {
         }
         std::cout << ")";
 
-        if (i < preset_parameters_.size() && !preset_parameters_[i].empty()) {
+        if (i < parameters.size() && !parameters[i].empty()) {
             std::cout << " params={";
             bool first = true;
-            for (const auto& [key, value] : preset_parameters_[i]) {
+            for (const auto& [key, value] : parameters[i]) {
                 if (!first) {
                     std::cout << ", ";
                 }
@@ -78,6 +90,57 @@ void ConfiguratorCLI::printPresets() {
     }
 }
 
+void ConfiguratorCLI::printStats() const {
+    std::lock_guard<std::mutex> guard(engine_mutex_);
+    const auto stats = engine_.renderStats();
+    std::cout << "Render stats:" << '\n'
+              << "  frames rendered:     " << stats.frames_rendered << '\n'
+              << "  scratch allocations: " << stats.scratch_allocations << '\n'
+              << "  layer renders:       " << stats.layer_renders << '\n'
+              << "  layer cache hits:    " << stats.layer_cache_hits << '\n'
+              << "  interpolated layers: " << stats.layer_interpolations << '\n'
+              << "  layers culled:       " << stats.layers_culled << '\n'
+              << "  frames sent:         " << stats.frames_sent << '\n'
+              << "  frames suppressed:   " << stats.frames_suppressed << '\n'
+              << "  frames dropped:      " << stats.frames_dropped << '\n'
+              << "  send failures:       " << stats.send_failures << '\n'
+              << "  reports sent:        " << stats.reports_sent << '\n'
+              << "  reports unchanged:   " << stats.reports_skipped << '\n';
+
+    const auto device = engine_.transportStats();
+    std::cout << "Device writes:" << '\n'
+              << "  device:              " << (device.device_connected ? "connected" : "disconnected")
+              << " (" << device.reconnects << " reconnects)" << '\n'
+              << "  writes:              " << device.writes << '\n'
+              << "  write failures:      " << device.write_failures << '\n'
+              << "  writes coalesced:    " << device.frames_coalesced << '\n'
+              << "  write stalls:        " << device.write_stalls << '\n'
+              << "  latency p50/p95/p99: " << device.latency_p50_ms << " / "
+              << device.latency_p95_ms << " / " << device.latency_p99_ms << " ms" << '\n'
+              << "  latency max:         " << device.latency_max_ms << " ms" << '\n';
+
+    const auto timing = scheduler_.stats();
+    std::cout << "Frame timing (target " << frame_interval_ms_.load() << " ms):" << '\n'
+              << "  scheduled frames:    " << timing.frames << '\n'
+              << "  overruns:            " << timing.overruns << '\n'
+              << "  skipped frames:      " << timing.skipped_frames << '\n'
+              << "  last period:         " << timing.last_period_ms << " ms" << '\n'
+              << "  mean period:         " << timing.mean_period_ms << " ms" << '\n'
+              << "  mean jitter:         " << timing.mean_jitter_ms << " ms" << '\n'
+              << "  max jitter:          " << timing.max_jitter_ms << " ms" << '\n'
+              << "  idle:                " << (idle_.load() ? "yes" : "no")
+              << " (entered " << idle_entries_.load() << " times)" << '\n';
+}
+
+void ConfiguratorCLI::setOverrunPolicy(OverrunPolicy policy) {
+    scheduler_.setPolicy(policy);
+}
+
+void ConfiguratorCLI::setIdlePolicy(IdlePolicy policy, KeyActivityProviderPtr activity) {
+    idle_policy_ = policy;
+    activity_ = std::move(activity);
+}
+
 bool ConfiguratorCLI::togglePreset(std::size_t index) {
     std::lock_guard<std::mutex> guard(engine_mutex_);
     if (index >= engine_.presetCount()) {
@@ -91,18 +154,10 @@ bool ConfiguratorCLI::togglePreset(std::size_t index) {
 bool ConfiguratorCLI::setPresetParameter(std::size_t index,
                                          const std::string& key,
                                          const std::string& value) {
-    std::lock_guard<std::mutex> guard(engine_mutex_);
-    if (index >= engine_.presetCount()) {
+    if (index >= preset_count_) {
         return false;
     }
-
-    if (index >= preset_parameters_.size()) {
-        preset_parameters_.resize(engine_.presetCount());
-    }
-
-    preset_parameters_[index][key] = value;
-    auto& preset = engine_.presetAt(index);
-    preset.configure(preset_parameters_[index]);
+    updateScene([&](Scene& scene) { scene.setParameter(index, key, value); });
     return true;
 }
 
@@ -149,7 +204,7 @@ void ConfiguratorCLI::handleSnakeCommand(const std::string& arg) {
     }
 
     if (should_refresh) {
-        syncRenderState(true);
+        requestRender();
     }
 }
 
@@ -158,9 +213,15 @@ bool ConfiguratorCLI::engineHasAnimated() const {
     return engine_.hasAnimatedEnabled();
 }
 
+// Render thread only.
 void ConfiguratorCLI::renderOnce(double time_seconds) {
+    // Cleared before the scene is read, so a later request renders again
+    render_requested_.store(false);
     std::lock_guard<std::mutex> guard(engine_mutex_);
+    syncScene();
     engine_.renderFrame(time_seconds);
+    // Only a hand-off: the engine's transport stage or an async transport's
+    // writer thread does the device write
     engine_.pushFrame();
 }
 
@@ -173,27 +234,116 @@ void ConfiguratorCLI::startRenderLoop() {
     loop_running_.store(true);
     start_time_ = std::chrono::steady_clock::now();
 
+    scheduler_.setPeriod(std::chrono::milliseconds(frame_interval_ms_.load()));
+    scheduler_.reset(start_time_);
+
     render_thread_ = std::thread([this]() {
+        bool paced = true;
         while (!stop_flag_.load()) {
-            auto now = std::chrono::steady_clock::now();
-            double elapsed = std::chrono::duration<double>(now - start_time_).count();
-            renderOnce(elapsed);
-
-            int interval = frame_interval_ms_.load();
-            if (interval < 1) {
-                interval = 1;
+            if (!engineHasAnimated()) {
+                // A static scene only changes when something publishes one
+                paced = false;
+                if (waitForRenderRequest()) {
+                    renderOnce(0.0);
+                }
+                continue;
+            }
+            if (!paced) {
+                scheduler_.reset(std::chrono::steady_clock::now());
+                paced = true;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+            if (waitWhileIdle()) {
+                continue;
+            }
+            // Animate on the deadline, not on wake-up time, so motion speed
+            // follows the configured interval however long frames take
+            const auto deadline = scheduler_.waitNext();
+            if (stop_flag_.load()) {
+                break;
+            }
+            double elapsed = std::chrono::duration<double>(deadline - start_time_).count();
+            renderOnce(elapsed);
         }
         loop_running_.store(false);
     });
 }
 
+// Handles one idle step of the render loop. Returns false when the loop is
+// active and should render on its normal schedule.
+bool ConfiguratorCLI::waitWhileIdle() {
+    if (!activity_ || idle_policy_.timeout.count() <= 0) {
+        return false;
+    }
+
+    // Sample the generation first so a press racing with the check still wakes us
+    const auto seen = activity_->activityGeneration();
+    const double last_press = activity_->lastActivitySeconds();
+    const double quiet = activity_->nowSeconds() - last_press;
+    const double timeout = std::chrono::duration<double>(idle_policy_.timeout).count();
+    if (quiet < timeout) {
+        return false;
+    }
+    if (!idle_.exchange(true)) {
+        ++idle_entries_;
+    }
+
+    // Focus changes, overlays and CLI edits show at once, not at the next tick
+    if (render_requested_.load()) {
+        const auto tick = std::chrono::steady_clock::now();
+        renderOnce(std::chrono::duration<double>(tick - start_time_).count());
+        return true;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto until = idle_policy_.interval.count() > 0
+        ? now + idle_policy_.interval
+        : now + std::chrono::hours(24);
+    if (activity_->waitForActivity(seen, until)) {
+        if (!stop_flag_.load() && activity_->lastActivitySeconds() != last_press) {
+            // Key press: resume full rate with a fresh schedule, rendering at once
+            idle_.store(false);
+            scheduler_.reset(std::chrono::steady_clock::now());
+        }
+        // Otherwise woken by requestRender() or shutdown; the next pass handles it
+        return true;
+    }
+
+    if (!stop_flag_.load()) {
+        const auto tick = std::chrono::steady_clock::now();
+        renderOnce(std::chrono::duration<double>(tick - start_time_).count());
+    }
+    return true;
+}
+
+// Blocks a static loop until a frame is requested. Returns false on shutdown.
+bool ConfiguratorCLI::waitForRenderRequest() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cv_.wait(lock, [this] { return render_requested_.load() || stop_flag_.load(); });
+    return !stop_flag_.load();
+}
+
+// Makes the render thread draw the latest scene now, even while static or
+// idle. Callers publish the change first; safe from any thread.
+void ConfiguratorCLI::requestRender() {
+    render_requested_.store(true);
+    wakeRenderLoop();
+}
+
+void ConfiguratorCLI::wakeRenderLoop() {
+    // Taking the lock orders the flag store before a waiter's predicate check
+    { std::lock_guard<std::mutex> lock(wake_mutex_); }
+    wake_cv_.notify_all();
+    if (activity_) {
+        activity_->wake();
+    }
+}
+
 void ConfiguratorCLI::stopRenderLoop() {
     if (!loop_running_.load()) {
         return;
     }
     stop_flag_.store(true);
+    wakeRenderLoop();
     if (render_thread_.joinable()) {
         render_thread_.join();
         render_thread_ = std::thread();
@@ -201,18 +351,9 @@ void ConfiguratorCLI::stopRenderLoop() {
     loop_running_.store(false);
 }
 
-void ConfiguratorCLI::syncRenderState(bool refresh_static_frame) {
-    const bool animated = engineHasAnimated();
-    if (animated) {
-        if (!loop_running_.load()) {
-            startRenderLoop();
-        }
-    } else {
-        stopRenderLoop();
-        if (refresh_static_frame) {
-            renderOnce(0.0);
-        }
-    }
+void ConfiguratorCLI::startRendering() {
+    startRenderLoop();
+    requestRender();
 }
 
 void ConfiguratorCLI::run() {
@@ -220,7 +361,7 @@ void ConfiguratorCLI::run() {
     printHelp();
     printPresets();
 
-    syncRenderState(true);
+    startRendering();
 
     std::string line;
     while (true) {
@@ -245,12 +386,14 @@ void ConfiguratorCLI::run() {
             printHelp();
         } else if (cmd == "list") {
             printPresets();
+        } else if (cmd == "stats") {
+            printStats();
         } else if (cmd == "toggle") {
             std::size_t index = 0;
             if (!(iss >> index) || !togglePreset(index)) {
                 std::cout << "Invalid preset index" << '\n';
             } else {
-                syncRenderState(true);
+                requestRender();
                 std::cout << "Toggled preset " << index << '\n';
             }
         } else if (cmd == "set") {
@@ -260,7 +403,7 @@ void ConfiguratorCLI::run() {
             if (!(iss >> index >> key >> value) || !setPresetParameter(index, key, value)) {
                 std::cout << "Invalid set command" << '\n';
             } else {
-                syncRenderState(true);
+                requestRender();
                 std::cout << "Updated preset " << index << " parameter " << key << '\n';
             }
         } else if (cmd == "frame") {
@@ -269,6 +412,11 @@ void ConfiguratorCLI::run() {
                 std::cout << "Invalid frame interval" << '\n';
             } else {
                 frame_interval_ms_.store(interval_ms);
+                scheduler_.setPeriod(std::chrono::milliseconds(interval_ms));
+                {
+                    std::lock_guard<std::mutex> guard(engine_mutex_);
+                    engine_.setFrameInterval(std::chrono::milliseconds(interval_ms));
+                }
                 std::cout << "Frame interval set to " << interval_ms << " ms" << '\n';
             }
         } else if (cmd == "snake") {
@@ -298,112 +446,116 @@ void ConfiguratorCLI::run() {
 
 // --- WATCHER INTERFACE ---
 
-void ConfiguratorCLI::setDrawList(const std::vector<std::size_t>& list) {
-    std::lock_guard<std::mutex> guard(engine_mutex_);
-    if (snake_override_active_) {
-        saved_draw_list_ = list;
-        saved_draw_list_valid_ = true;
-        return;
-    }
-    current_draw_list_ = list;
-    engine_.setDrawList(list);
+ScenePtr ConfiguratorCLI::scene() const {
+    return std::atomic_load(&scene_);
 }
 
-void ConfiguratorCLI::applyPresetMasks(const std::vector<std::vector<bool>>& masks) {
-    std::lock_guard<std::mutex> guard(engine_mutex_);
-    if (snake_override_active_) {
-        saved_masks_ = masks;
-        saved_masks_valid_ = true;
-        return;
+void ConfiguratorCLI::updateScene(const std::function<void(Scene&)>& edit) {
+    ScenePtr current = std::atomic_load(&scene_);
+    while (true) {
+        auto next = std::make_shared<Scene>(*current);
+        edit(*next);
+        next->version = current->version + 1;
+        ScenePtr published = std::move(next);
+        // On failure `current` is refreshed to the winner and the edit is replayed on it
+        if (std::atomic_compare_exchange_weak(&scene_, &current, published)) {
+            requestRender();
+            return;
+        }
     }
-    current_masks_ = masks;
-    engine_.setPresetMasks(masks, true);
+}
+
+void ConfiguratorCLI::setDrawList(const std::vector<std::size_t>& list) {
+    updateScene([&](Scene& scene) { scene.draw_list = list; });
+}
+
+void ConfiguratorCLI::applyPresetMasks(const std::vector<KeyMask>& masks) {
+    auto shared = std::make_shared<const MaskSet>(masks);
+    updateScene([&](Scene& scene) { scene.masks = shared; });
 }
 
 void ConfiguratorCLI::refreshRender() {
-    syncRenderState(true);
+    requestRender();
 }
 
-void ConfiguratorCLI::applyPresetMask(std::size_t index, const std::vector<bool>& mask) {
-    std::lock_guard<std::mutex> guard(engine_mutex_);
-    if (index < engine_.presetCount()) {
-        if (snake_override_active_) {
-            if (saved_masks_.size() < engine_.presetCount()) {
-                saved_masks_.resize(engine_.presetCount());
-            }
-            saved_masks_[index] = mask;
-            saved_masks_valid_ = true;
+void ConfiguratorCLI::applyPresetMask(std::size_t index, const KeyMask& mask) {
+    if (index >= preset_count_) return;
+    updateScene([&](Scene& scene) { scene.setMask(index, mask); });
+}
+
+void ConfiguratorCLI::applyPresetParameter(std::size_t index, const std::string& key, const std::string& value) {
+    if (index >= preset_count_) return;
+    const auto current = scene();
+    if (index < current->parameters.size()) {
+        auto it = current->parameters[index].find(key);
+        if (it != current->parameters[index].end() && it->second == value) {
             return;
         }
-        if (current_masks_.size() < engine_.presetCount()) {
-            current_masks_.resize(engine_.presetCount());
-        }
-        current_masks_[index] = mask;
-        engine_.setPresetMask(index, mask);
     }
+    updateScene([&](Scene& scene) { scene.setParameter(index, key, value); });
 }
 
-void ConfiguratorCLI::applyPresetParameter(std::size_t index, const std::string& key, const std::string& value) {
-    std::lock_guard<std::mutex> guard(engine_mutex_);
-    if (index >= engine_.presetCount()) return;
-    
-    if (index >= preset_parameters_.size()) {
-        preset_parameters_.resize(engine_.presetCount());
-    }
-    
-    if (preset_parameters_[index][key] != value) {
-        preset_parameters_[index][key] = value;
-        auto& preset = engine_.presetAt(index);
-        preset.configure(preset_parameters_[index]);
+// Called with engine_mutex_ held, at a frame boundary.
+void ConfiguratorCLI::syncScene() {
+    const auto current = std::atomic_load(&scene_);
+    if (!scene_reapply_ && current->version == applied_scene_version_) {
+        return;
     }
+    applyScene(*current);
 }
 
-void ConfiguratorCLI::applySnakeOverride(std::size_t snake_index)
-{
-    snake_override_active_ = true;
+void ConfiguratorCLI::applyScene(const Scene& scene) {
+    const auto count = engine_.presetCount();
+    const auto key_count = model_.keyCount();
+
+    if (applied_parameters_.size() < scene.parameters.size()) {
+        applied_parameters_.resize(scene.parameters.size());
+    }
+    for (std::size_t i = 0; i < std::min(count, scene.parameters.size()); ++i) {
+        if (applied_parameters_[i] != scene.parameters[i]) {
+            applied_parameters_[i] = scene.parameters[i];
+            engine_.configurePreset(i, applied_parameters_[i]);
+        }
+    }
 
-    saved_draw_list_ = current_draw_list_;
-    saved_draw_list_valid_ = true;
+    if (scene.masks && (scene_reapply_ || scene.masks != applied_masks_)) {
+        const auto& masks = *scene.masks;
+        for (std::size_t i = 0; i < std::min(count, masks.size()); ++i) {
+            if (masks[i].size() == key_count) {
+                engine_.setPresetMask(i, masks[i]);
+            }
+        }
+    }
+    applied_masks_ = scene.masks;
 
-    if (!current_masks_.empty()) {
-        saved_masks_ = current_masks_;
-        saved_masks_valid_ = true;
+    if (snake_override_) {
+        // The game owns the whole keyboard until it stops; the scene still
+        // tracks watcher updates and is reapplied afterwards.
+        engine_.setDrawList({*snake_override_});
+        engine_.setPresetMask(*snake_override_, KeyMask(key_count, true));
     } else {
-        saved_masks_.clear();
-        saved_masks_valid_ = false;
+        engine_.setDrawList(scene.draw_list);
     }
 
-    std::vector<std::size_t> snake_only = { snake_index };
-    engine_.setDrawList(snake_only);
-    current_draw_list_ = snake_only;
+    applied_scene_version_ = scene.version;
+    scene_reapply_ = false;
+}
 
-    std::vector<bool> full(model_.keyCount(), true);
-    engine_.setPresetMask(snake_index, full);
+void ConfiguratorCLI::applySnakeOverride(std::size_t snake_index)
+{
+    std::lock_guard<std::mutex> guard(engine_mutex_);
+    snake_override_ = snake_index;
+    scene_reapply_ = true;
 }
 
 void ConfiguratorCLI::clearSnakeOverride()
 {
-    if (!snake_override_active_)
+    std::lock_guard<std::mutex> guard(engine_mutex_);
+    if (!snake_override_)
         return;
 
-    snake_override_active_ = false;
-
-    if (saved_draw_list_valid_) {
-        engine_.setDrawList(saved_draw_list_);
-        current_draw_list_ = saved_draw_list_;
-    } else {
-        engine_.setDrawList(current_draw_list_);
-    }
-
-    if (saved_masks_valid_) {
-        engine_.setPresetMasks(saved_masks_, true);
-        current_masks_ = saved_masks_;
-    }
-
-    saved_draw_list_valid_ = false;
-    saved_masks_valid_ = false;
-    saved_draw_list_.clear();
-    saved_masks_.clear();
+    snake_override_.reset();
+    scene_reapply_ = true;
 }
 
 // --- CONFIG WATCH INTERFACE ---
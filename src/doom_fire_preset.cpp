@@ -4,6 +4,8 @@
 #include <cctype>
 #include <cmath>
 
+#include "keyboard_configurator/color.hpp"
+
 namespace kb::cfg {
 namespace {
 std::vector<std::string> splitCommaList(const std::string& value) {
@@ -68,6 +70,7 @@ void DoomFirePreset::configure(const ParameterMap& params) {
                 palette_.push_back(parseHexColor(token));
             }
         }
+        palette_lut_ = GradientLut{};
         ensurePalette();
     }
 }
@@ -100,15 +103,16 @@ void DoomFirePreset::render(const KeyboardModel& model,
     simulate(delta);
     last_time_ = time_seconds;
 
+    auto out = frame.span(key_count);
     for (std::size_t key = 0; key < key_count; ++key) {
         RgbColor color{0, 0, 0};
         if (key < key_to_cell_.size()) {
             int cell = key_to_cell_[key];
             if (cell >= 0 && cell < static_cast<int>(heat_.size())) {
-                color = colorForHeat(heat_[cell]);
+                color = palette_lut_.at(heat_[cell]);
             }
         }
-        frame.setColor(key, color);
+        out[key] = color;
     }
 }
 
@@ -149,6 +153,9 @@ void DoomFirePreset::buildGrid(const KeyboardModel& model) {
 
 void DoomFirePreset::ensurePalette() {
     if (!palette_.empty()) {
+        if (palette_lut_.empty()) {
+            palette_lut_ = GradientLut::fromStops(palette_, false, 256);
+        }
         return;
     }
     constexpr const char* DEFAULT_PALETTE[] = {
@@ -158,6 +165,7 @@ void DoomFirePreset::ensurePalette() {
     for (const char* hex : DEFAULT_PALETTE) {
         palette_.push_back(parseHexColor(hex));
     }
+    palette_lut_ = GradientLut::fromStops(palette_, false, 256);
 }
 
 void DoomFirePreset::simulate(double delta_seconds) {
@@ -225,37 +233,4 @@ void DoomFirePreset::propagateFlames() {
     }
 }
 
-RgbColor DoomFirePreset::colorForHeat(double heat) const {
-    if (palette_.empty()) {
-        return {0, 0, 0};
-    }
-    heat = std::clamp(heat, 0.0, 1.0);
-    const double pos = heat * (palette_.size() - 1);
-    const std::size_t i0 = static_cast<std::size_t>(std::floor(pos));
-    const std::size_t i1 = std::min(i0 + 1, palette_.size() - 1);
-    const double t = pos - static_cast<double>(i0);
-    const auto& a = palette_[i0];
-    const auto& b = palette_[i1];
-    auto lerp8 = [](std::uint8_t u, std::uint8_t v, double f) {
-        return static_cast<std::uint8_t>(std::clamp<int>(static_cast<int>(std::lround(u + (v - u) * f)), 0, 255));
-    };
-    return {lerp8(a.r, b.r, t), lerp8(a.g, b.g, t), lerp8(a.b, b.b, t)};
-}
-
-RgbColor DoomFirePreset::parseHexColor(const std::string& value) {
-    if (value.size() != 7 || value.front() != '#') {
-        return {255, 255, 255};
-    }
-    auto hexValue = [](char ch) -> int {
-        if (ch >= '0' && ch <= '9') return ch - '0';
-        char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
-        if (upper >= 'A' && upper <= 'F') return 10 + (upper - 'A');
-        return 0;
-    };
-    auto hexComponent = [&](std::size_t idx) -> std::uint8_t {
-        return static_cast<std::uint8_t>((hexValue(value[idx]) << 4) | hexValue(value[idx + 1]));
-    };
-    return {hexComponent(1), hexComponent(3), hexComponent(5)};
-}
-
 }  // namespace kb::cfg
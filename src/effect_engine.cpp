@@ -1,12 +1,20 @@
 #include "keyboard_configurator/effect_engine.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <stdexcept>
 
 namespace kb::cfg {
 
 EffectEngine::EffectEngine(const KeyboardModel& model, DeviceTransport& transport)
-    : model_(model), transport_(transport), frame_(model.keyCount()) {}
+    : model_(model), transport_(transport), frame_(model.keyCount()) {
+    output_.setLayout(model_);
+}
+
+EffectEngine::~EffectEngine() {
+    stopTransportStage();
+}
 
 void EffectEngine::setPresets(std::vector<std::unique_ptr<LightingPreset>> presets) {
     presets_ = std::move(presets);
@@ -16,6 +24,12 @@ void EffectEngine::setPresets(std::vector<std::unique_ptr<LightingPreset>> prese
     preset_ids_.clear();
     preset_animated_.clear();
     preset_masks_.clear();
+    preset_blend_.assign(presets_.size(), LayerBlend{});
+    preset_alpha_.assign(presets_.size(), {});
+    layer_coverage_.assign(presets_.size(), std::vector<std::uint8_t>(model_.keyCount(), 255));
+    layer_opaque_.assign(presets_.size(), true);
+    coverage_dirty_ = true;
+    plan_dirty_ = true;
     
     preset_ids_.reserve(presets_.size());
     preset_animated_.reserve(presets_.size());
@@ -26,6 +40,14 @@ void EffectEngine::setPresets(std::vector<std::unique_ptr<LightingPreset>> prese
     }
     
     frame_.resize(model_.keyCount());
+    layer_frames_.assign(presets_.size(), KeyColorFrame(model_.keyCount()));
+    layer_cached_.assign(presets_.size(), false);
+    layer_dropped_.assign(presets_.size(), 0);
+    layer_drawn_.assign(presets_.size(), 0);
+    preset_update_hz_.assign(presets_.size(), 0.0);
+    layer_clocks_.clear();
+    refreshLayerRates();
+    layer_visible_.assign(presets_.size(), {});
     
     // Default Legacy Behavior: Enable Index 0 only
     preset_enabled_.assign(presets_.size(), false);
@@ -43,7 +65,7 @@ void EffectEngine::setPresets(std::vector<std::unique_ptr<LightingPreset>> prese
 }
 
 void EffectEngine::setPresets(std::vector<std::unique_ptr<LightingPreset>> presets,
-                              std::vector<std::vector<bool>> masks) {
+                              std::vector<KeyMask> masks) {
     setPresets(std::move(presets));
     if (masks.size() == preset_masks_.size()) {
         const auto kc = model_.keyCount();
@@ -53,11 +75,16 @@ void EffectEngine::setPresets(std::vector<std::unique_ptr<LightingPreset>> prese
             }
         }
     }
+    coverage_dirty_ = true;
 }
 
 // --- THIS WAS MISSING ---
 void EffectEngine::setDrawList(std::vector<std::size_t> draw_list) {
+    if (draw_list == active_draw_list_) {
+        return;
+    }
     active_draw_list_ = std::move(draw_list);
+    plan_dirty_ = true;
 }
 
 void EffectEngine::setKeyActivityProvider(KeyActivityProviderPtr provider) {
@@ -66,54 +93,266 @@ void EffectEngine::setKeyActivityProvider(KeyActivityProviderPtr provider) {
 }
 
 void EffectEngine::renderFrame(double time_seconds) {
-    if (frame_.size() != model_.keyCount()) {
-        frame_.resize(model_.keyCount());
-    }
-
-    frame_.fill({0, 0, 0});
-    
-    KeyColorFrame temp(model_.keyCount());
     const auto kc = model_.keyCount();
+    if (frame_.size() != kc) {
+        frame_.resize(kc);
+        ++stats_.scratch_allocations;
+    }
+    ensureLayerFrames(kc);
+    if (coverage_dirty_) {
+        compileCoverage(kc);
+    }
 
-    auto renderLayer = [&](std::size_t idx) {
-        if (idx >= presets_.size()) return;
+    if (plan_dirty_) {
+        compileRenderPlan(kc);
+    }
 
-        temp.resize(kc);
-        temp.fill({0, 0, 0});
-        presets_[idx]->render(model_, time_seconds, temp);
+    // Render phase: every distinct layer that survived culling and is not
+    // cached draws into its own scratch frame. Layers are independent here,
+    // so with a pool they run concurrently.
+    pending_layers_.clear();
+    for (std::size_t idx : plan_layers_) {
+        if (layer_cached_[idx]) {
+            ++stats_.layer_cache_hits;
+        } else {
+            pending_layers_.push_back(idx);
+        }
+    }
 
-        const auto& mask = (idx < preset_masks_.size()) ? preset_masks_[idx] : std::vector<bool>();
-        
-        if (!mask.empty()) {
-            for (std::size_t k = 0; k < kc; ++k) {
-                if (mask[k]) {
-                    frame_.setColor(k, temp.color(k));
-                }
-            }
+    std::fill(layer_dropped_.begin(), layer_dropped_.end(), 0);
+    std::fill(layer_drawn_.begin(), layer_drawn_.end(), 0);
+    auto render_layer = [this, time_seconds](std::size_t job) {
+        const std::size_t idx = pending_layers_[job];
+        if (layer_clocks_[idx].rate_hz > 0.0) {
+            tickLayer(idx, time_seconds);
         } else {
-            for (std::size_t k = 0; k < kc; ++k) {
-                frame_.setColor(k, temp.color(k));
-            }
+            drawLayer(idx, time_seconds, layer_frames_[idx]);
         }
     };
+    if (render_pool_ && pending_layers_.size() > 1) {
+        render_pool_->run(pending_layers_.size(), render_layer);
+    } else {
+        for (std::size_t job = 0; job < pending_layers_.size(); ++job) {
+            render_layer(job);
+        }
+    }
 
-    if (!active_draw_list_.empty()) {
-        for (std::size_t idx : active_draw_list_) {
-            renderLayer(idx);
+    for (std::size_t idx : pending_layers_) {
+        if (layer_drawn_[idx] != 0) {
+            stats_.layer_renders += layer_drawn_[idx];
+        } else {
+            ++stats_.layer_interpolations;
+        }
+        if (layer_dropped_[idx] != 0) {
+            ++stats_.scratch_allocations;
+            continue;
         }
+        layer_cached_[idx] = !preset_animated_[idx];
+    }
+
+    // Compose phase: painter's order, always on this thread. With linear
+    // blending the layers accumulate in float and are quantised once by the
+    // output stage.
+    const bool linear = output_.linearBlend();
+    const bool staged = linear || !output_.isIdentity();
+    if (staged && linear_frame_.size() != kc) {
+        linear_frame_.resize(kc);
+        ++stats_.scratch_allocations;
+    }
+    if (linear) {
+        linear_frame_.clear();
     } else {
-        for (std::size_t idx = 0; idx < presets_.size(); ++idx) {
-            if (!preset_enabled_.empty() && !preset_enabled_[idx]) {
-                continue;
-            }
-            renderLayer(idx);
+        frame_.fill({0, 0, 0});
+    }
+    RgbColor* out = frame_.data();
+    for (std::size_t pass = 0; pass < render_order_.size(); ++pass) {
+        const std::size_t idx = render_order_[pass];
+        if (!pass_visible_[pass].any()) {
+            ++stats_.layers_culled;
+            continue;
+        }
+        if (layer_dropped_[idx]) {
+            continue;
+        }
+        const auto* coverage = layer_opaque_[idx] ? nullptr : layer_coverage_[idx].data();
+        if (linear) {
+            blendLayerLinear(preset_blend_[idx].mode, linear_frame_, layer_frames_[idx].data(), coverage, kc);
+        } else {
+            blendLayer(preset_blend_[idx].mode, out, layer_frames_[idx].data(), coverage, kc);
         }
     }
+    if (staged) {
+        if (!linear) {
+            linear_frame_.decode(out, kc);
+        }
+        output_.process(linear_frame_, out);
+    }
+    if (frame_ring_) {
+        frame_ring_->publish(frame_);
+    }
+    ++stats_.frames_rendered;
 }
 
 bool EffectEngine::pushFrame() {
-    const auto payload = model_.encodeFrame(frame_);
-    return transport_.sendFrame(model_, payload);
+    model_.encodeFrame(frame_, payload_);
+    const auto now = std::chrono::steady_clock::now();
+
+    if (send_failed_.exchange(false)) {
+        // A pipelined send failed; the device may not hold last_sent_payload_
+        has_sent_frame_ = false;
+    }
+
+    bool keepalive = false;
+    if (has_sent_frame_ && payload_ == last_sent_payload_) {
+        keepalive = keepalive_interval_.count() > 0 &&
+                    now - last_sent_time_ >= keepalive_interval_;
+        if (!keepalive) {
+            ++stats_.frames_suppressed;
+            return true;
+        }
+    }
+
+    if (transport_stage_running_) {
+        if (mailbox_.post(payload_, keepalive)) {
+            ++stats_.frames_dropped;
+        }
+        has_sent_frame_ = true;
+        last_sent_payload_ = payload_;
+        last_sent_time_ = now;
+        return true;
+    }
+
+    if (!deliver(payload_, keepalive)) {
+        // Forget the last sent frame so the next push sends even an identical one
+        has_sent_frame_ = false;
+        ++send_failures_;
+        return false;
+    }
+    has_sent_frame_ = true;
+    last_sent_payload_ = payload_;
+    last_sent_time_ = now;
+    ++frames_sent_;
+    return true;
+}
+
+bool EffectEngine::deliver(const std::vector<std::uint8_t>& payload, bool force) {
+    const std::size_t report_size = model_.packetLength();
+    const std::size_t reports = report_size > 0 ? payload.size() / report_size : 0;
+    const bool comparable = !force && reports > 1 &&
+                            device_payload_.size() == payload.size() &&
+                            reports * report_size == payload.size();
+    if (!comparable) {
+        // Single report, keep-alive or unknown device state: send everything
+        if (!transport_.sendFrame(model_, payload)) {
+            device_payload_.clear();
+            return false;
+        }
+        reports_sent_ += std::max<std::size_t>(reports, 1);
+        device_payload_.assign(payload.begin(), payload.end());
+        return true;
+    }
+
+    dirty_reports_.assign(reports, 0);
+    std::size_t dirty = 0;
+    for (std::size_t r = 0; r < reports; ++r) {
+        const auto offset = static_cast<std::ptrdiff_t>(r * report_size);
+        if (!std::equal(payload.begin() + offset,
+                        payload.begin() + offset + static_cast<std::ptrdiff_t>(report_size),
+                        device_payload_.begin() + offset)) {
+            dirty_reports_[r] = 1;
+            ++dirty;
+        }
+    }
+    reports_skipped_ += reports - dirty;
+    if (dirty == 0) {
+        return true;
+    }
+    if (!transport_.sendReports(model_, payload, dirty_reports_)) {
+        device_payload_.clear();
+        return false;
+    }
+    reports_sent_ += dirty;
+    device_payload_.assign(payload.begin(), payload.end());
+    return true;
+}
+
+void EffectEngine::startTransportStage() {
+    if (transport_stage_running_) {
+        return;
+    }
+    mailbox_.reopen();
+    transport_stage_running_ = true;
+    transport_thread_ = std::thread([this] { transportLoop(); });
+}
+
+void EffectEngine::stopTransportStage() {
+    if (!transport_stage_running_) {
+        return;
+    }
+    mailbox_.close();
+    if (transport_thread_.joinable()) {
+        transport_thread_.join();
+    }
+    transport_stage_running_ = false;
+}
+
+void EffectEngine::transportLoop() {
+    std::vector<std::uint8_t> payload;
+    bool force = false;
+    while (mailbox_.take(payload, force)) {
+        if (deliver(payload, force)) {
+            ++frames_sent_;
+        } else {
+            ++send_failures_;
+            send_failed_.store(true);
+        }
+    }
+}
+
+EffectEngine::RenderStats EffectEngine::renderStats() const {
+    RenderStats stats = stats_;
+    stats.frames_sent = frames_sent_.load();
+    stats.send_failures = send_failures_.load();
+    stats.reports_sent = reports_sent_.load();
+    stats.reports_skipped = reports_skipped_.load();
+    return stats;
+}
+
+TransportStats EffectEngine::transportStats() const {
+    return transport_.transportStats();
+}
+
+void EffectEngine::setRenderThreads(std::size_t threads) {
+    if (threads <= 1) {
+        render_pool_.reset();
+        return;
+    }
+    if (render_pool_ && render_pool_->threadCount() == threads) {
+        return;
+    }
+    render_pool_ = std::make_unique<RenderPool>(threads);
+}
+
+void EffectEngine::setKeepAliveInterval(std::chrono::milliseconds interval) {
+    keepalive_interval_ = std::max(std::chrono::milliseconds{0}, interval);
+}
+
+void EffectEngine::setOutputSettings(const OutputSettings& settings) {
+    output_.configure(settings);
+}
+
+void EffectEngine::setFrameRing(std::shared_ptr<SharedFrameRing> ring) {
+    frame_ring_ = std::move(ring);
+}
+
+void EffectEngine::configurePreset(std::size_t index, const ParameterMap& params) {
+    if (index >= presets_.size()) {
+        throw std::out_of_range("EffectEngine::configurePreset index out of range");
+    }
+    presets_[index]->configure(params);
+    preset_animated_[index] = presets_[index]->isAnimated();
+    layer_cached_[index] = false;
+    refreshLayerRates();
 }
 
 LightingPreset& EffectEngine::presetAt(std::size_t index) {
@@ -138,6 +377,7 @@ void EffectEngine::setPresetEnabled(std::size_t index, bool enabled) {
         preset_enabled_.assign(presets_.size(), true);
     }
     preset_enabled_[index] = enabled;
+    plan_dirty_ = true;
 }
 
 bool EffectEngine::presetEnabled(std::size_t index) const {
@@ -169,7 +409,7 @@ bool EffectEngine::hasAnimatedEnabled() const {
     return false;
 }
 
-void EffectEngine::setPresetMask(std::size_t index, const std::vector<bool>& mask) {
+void EffectEngine::setPresetMask(std::size_t index, const KeyMask& mask) {
     if (index >= preset_masks_.size()) {
         throw std::out_of_range("EffectEngine::setPresetMask index out of range");
     }
@@ -177,10 +417,15 @@ void EffectEngine::setPresetMask(std::size_t index, const std::vector<bool>& mas
     if (mask.size() != kc) {
         throw std::invalid_argument("EffectEngine::setPresetMask mask size mismatch");
     }
+    if (preset_masks_[index] == mask) {
+        return;
+    }
     preset_masks_[index] = mask;
+    coverage_dirty_ = true;
+    layer_cached_[index] = false;
 }
 
-void EffectEngine::setPresetMasks(const std::vector<std::vector<bool>>& masks, bool overlay_replace) {
+void EffectEngine::setPresetMasks(const std::vector<KeyMask>& masks, bool overlay_replace) {
     (void)overlay_replace; 
     const auto pc = presets_.size();
     if (masks.size() != pc) {
@@ -192,6 +437,236 @@ void EffectEngine::setPresetMasks(const std::vector<std::vector<bool>>& masks, b
             preset_masks_[i] = masks[i];
         }
     }
+    coverage_dirty_ = true;
+    invalidateLayerCache();
+}
+
+void EffectEngine::setPresetBlend(std::size_t index, LayerBlend blend) {
+    if (index >= preset_blend_.size()) {
+        throw std::out_of_range("EffectEngine::setPresetBlend index out of range");
+    }
+    preset_blend_[index] = blend;
+    coverage_dirty_ = true;
+}
+
+void EffectEngine::setPresetAlpha(std::size_t index, std::vector<std::uint8_t> alpha) {
+    if (index >= preset_alpha_.size()) {
+        throw std::out_of_range("EffectEngine::setPresetAlpha index out of range");
+    }
+    if (!alpha.empty() && alpha.size() != model_.keyCount()) {
+        throw std::invalid_argument("EffectEngine::setPresetAlpha alpha size mismatch");
+    }
+    preset_alpha_[index] = std::move(alpha);
+    coverage_dirty_ = true;
+}
+
+void EffectEngine::compileCoverage(std::size_t key_count) {
+    layer_coverage_.resize(presets_.size());
+    layer_opaque_.resize(presets_.size());
+    layer_touched_.resize(presets_.size());
+    layer_solid_.resize(presets_.size());
+    for (std::size_t i = 0; i < presets_.size(); ++i) {
+        auto& coverage = layer_coverage_[i];
+        coverage.resize(key_count);
+
+        const auto* mask = (i < preset_masks_.size() && preset_masks_[i].size() == key_count)
+            ? &preset_masks_[i] : nullptr;
+        const auto* alpha = (i < preset_alpha_.size() && preset_alpha_[i].size() == key_count)
+            ? &preset_alpha_[i] : nullptr;
+        const auto opacity = i < preset_blend_.size() ? preset_blend_[i].opacity : std::uint8_t{255};
+
+        if (mask != nullptr) {
+            mask->select(coverage.data(), opacity, 0);
+        } else {
+            std::fill(coverage.begin(), coverage.end(), opacity);
+        }
+
+        auto& touched = layer_touched_[i];
+        auto& solid = layer_solid_[i];
+        if (alpha == nullptr) {
+            // Weights are uniform inside the mask, so both sets follow it directly
+            if (mask != nullptr) {
+                touched = *mask;
+            } else {
+                touched.assign(key_count, true);
+            }
+            if (opacity == 0) touched.fill(false);
+            solid = touched;
+            if (opacity != 255) solid.fill(false);
+        } else {
+            touched.assign(key_count, false);
+            solid.assign(key_count, false);
+            for (std::size_t k = 0; k < key_count; ++k) {
+                const unsigned weight = (coverage[k] * (*alpha)[k] + 127u) / 255u;
+                coverage[k] = static_cast<std::uint8_t>(weight);
+                if (weight != 0) touched.set(k);
+                if (weight == 255) solid.set(k);
+            }
+        }
+        layer_opaque_[i] = solid.all();
+    }
+    coverage_dirty_ = false;
+    plan_dirty_ = true;
+}
+
+void EffectEngine::compileRenderPlan(std::size_t key_count) {
+    render_order_.clear();
+    if (!active_draw_list_.empty()) {
+        for (std::size_t idx : active_draw_list_) {
+            if (idx < presets_.size()) {
+                render_order_.push_back(idx);
+            }
+        }
+    } else {
+        for (std::size_t idx = 0; idx < presets_.size(); ++idx) {
+            if (preset_enabled_.empty() || preset_enabled_[idx]) {
+                render_order_.push_back(idx);
+            }
+        }
+    }
+
+    // Walk top-down: a key is visible in a pass if the layer covers it and no
+    // opaque alpha layer above has claimed it.
+    pass_visible_.resize(render_order_.size());
+    covered_.assign(key_count, false);
+    for (std::size_t pass = render_order_.size(); pass-- > 0;) {
+        const std::size_t idx = render_order_[pass];
+        auto& visible = pass_visible_[pass];
+        visible = layer_touched_[idx];
+        visible.andNot(covered_);
+        if (preset_blend_[idx].mode == BlendMode::Alpha) {
+            covered_ |= layer_solid_[idx];
+        }
+    }
+
+    // Each distinct layer renders once per frame, for the union of the keys
+    // visible in any of its passes.
+    plan_layers_.clear();
+    merged_visible_.assign(presets_.size(), KeyMask(key_count));
+    for (std::size_t pass = 0; pass < render_order_.size(); ++pass) {
+        const auto& visible = pass_visible_[pass];
+        if (!visible.any()) {
+            continue;
+        }
+        const std::size_t idx = render_order_[pass];
+        auto& merged = merged_visible_[idx];
+        if (!merged.any()) {
+            plan_layers_.push_back(idx);
+        }
+        merged |= visible;
+    }
+    for (std::size_t idx : plan_layers_) {
+        layer_visible_[idx] = merged_visible_[idx].indices();
+    }
+
+    // Cached static layers may have been rendered for a different visible set
+    invalidateLayerCache();
+    plan_dirty_ = false;
+}
+
+void EffectEngine::ensureLayerFrames(std::size_t key_count) {
+    if (layer_frames_.size() != presets_.size()) {
+        layer_frames_.resize(presets_.size());
+        layer_cached_.assign(presets_.size(), false);
+        ++stats_.scratch_allocations;
+    }
+    for (std::size_t i = 0; i < layer_frames_.size(); ++i) {
+        if (layer_frames_[i].size() != key_count) {
+            layer_frames_[i].resize(key_count);
+            layer_cached_[i] = false;
+            ++stats_.scratch_allocations;
+        }
+    }
+}
+
+void EffectEngine::invalidateLayerCache() {
+    std::fill(layer_cached_.begin(), layer_cached_.end(), false);
+    // Interpolation samples may hold keys that were culled when rendered
+    for (auto& clock : layer_clocks_) {
+        clock.primed = false;
+    }
+}
+
+// Renders one layer into `target`, restricted to its visible keys. Runs on
+// render jobs, so it only touches state owned by layer `index`.
+void EffectEngine::drawLayer(std::size_t index, double time_seconds, KeyColorFrame& target) {
+    const auto kc = model_.keyCount();
+    const auto& visible = layer_visible_[index];
+    target.fill({0, 0, 0});
+    if (visible.size() == kc) {
+        presets_[index]->render(model_, time_seconds, target);
+    } else {
+        presets_[index]->renderVisible(model_, time_seconds, target, visible);
+    }
+    ++layer_drawn_[index];
+    if (target.size() != kc) {
+        // A preset resized its target; restore it so the next frame reuses it
+        target.resize(kc);
+        layer_dropped_[index] = 1;
+    }
+}
+
+void EffectEngine::tickLayer(std::size_t index, double time_seconds) {
+    const auto kc = model_.keyCount();
+    auto& clock = layer_clocks_[index];
+    if (clock.previous.size() != kc) clock.previous.resize(kc);
+    if (clock.current.size() != kc) clock.current.resize(kc);
+
+    const double period = 1.0 / clock.rate_hz;
+    const double since_tick = time_seconds - clock.last_tick;
+    if (!clock.primed || since_tick < 0.0 || since_tick >= 2.0 * period) {
+        // (Re)start, or too far behind to interpolate: both samples are now
+        drawLayer(index, time_seconds, clock.current);
+        clock.previous.colors() = clock.current.colors();
+        clock.last_tick = time_seconds;
+        clock.primed = true;
+    } else if (since_tick >= period) {
+        std::swap(clock.previous, clock.current);
+        clock.last_tick += period;  // stay on the layer's own grid
+        drawLayer(index, clock.last_tick, clock.current);
+    }
+
+    // Output trails the newest render by up to one period, which is what
+    // lets it move smoothly between two known samples.
+    const double phase = std::clamp((time_seconds - clock.last_tick) / period, 0.0, 1.0);
+    lerpFrames(layer_frames_[index].data(),
+               clock.previous.data(),
+               clock.current.data(),
+               static_cast<std::uint8_t>(std::lround(phase * 255.0)),
+               kc);
+}
+
+void EffectEngine::setPresetUpdateRate(std::size_t index, double hz) {
+    if (index >= preset_update_hz_.size()) {
+        throw std::out_of_range("EffectEngine::setPresetUpdateRate index out of range");
+    }
+    preset_update_hz_[index] = std::max(0.0, hz);
+    refreshLayerRates();
+}
+
+void EffectEngine::setFrameInterval(std::chrono::milliseconds interval) {
+    frame_interval_seconds_ = std::chrono::duration<double>(std::max(std::chrono::milliseconds{0}, interval)).count();
+    refreshLayerRates();
+}
+
+void EffectEngine::refreshLayerRates() {
+    layer_clocks_.resize(presets_.size());
+    for (std::size_t i = 0; i < presets_.size(); ++i) {
+        const double configured = i < preset_update_hz_.size() ? preset_update_hz_[i] : 0.0;
+        double rate = preset_animated_[i]
+            ? (configured > 0.0 ? configured : presets_[i]->updateRateHz())
+            : 0.0;
+        // A layer ticking at least once per device frame would always show
+        // its older sample; plain per-frame rendering is both fresher and no
+        // more work.
+        if (frame_interval_seconds_ > 0.0 && rate * frame_interval_seconds_ >= 1.0 - 1e-9) {
+            rate = 0.0;
+        }
+        if (layer_clocks_[i].rate_hz != rate) {
+            layer_clocks_[i].rate_hz = rate;
+            layer_clocks_[i].primed = false;
+        }
+    }
 }
 
 void EffectEngine::applyKeyActivityProvider() {
@@ -0,0 +1,270 @@
+#include "keyboard_configurator/frame_capture.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace kb::cfg {
+
+namespace {
+
+constexpr char kMagic[6] = {'K', 'B', 'C', 'A', 'P', '\0'};
+constexpr std::uint16_t kVersion = 1;
+
+enum : std::uint8_t {
+    kKeyFrame = 0,
+    kDeltaFrame = 1,
+};
+
+enum : std::uint8_t {
+    kHasUsagePage = 0x01,
+    kHasUsage = 0x02,
+};
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void putLe(std::vector<std::uint8_t>& out, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+// Returns false at a clean end of file, throws on a truncated value
+bool getByte(std::ifstream& in, std::uint8_t& byte) {
+    char ch = 0;
+    if (!in.get(ch)) {
+        return false;
+    }
+    byte = static_cast<std::uint8_t>(ch);
+    return true;
+}
+
+std::uint8_t needByte(std::ifstream& in) {
+    std::uint8_t byte = 0;
+    if (!getByte(in, byte)) {
+        throw std::runtime_error("Capture file is truncated");
+    }
+    return byte;
+}
+
+std::uint64_t getVarint(std::ifstream& in) {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        const std::uint8_t byte = needByte(in);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Capture file has a malformed varint");
+}
+
+std::uint64_t getLe(std::ifstream& in, std::size_t bytes) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(needByte(in)) << (8 * i);
+    }
+    return value;
+}
+
+void readBytes(std::ifstream& in, std::uint8_t* dst, std::size_t count) {
+    if (count > 0 && !in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(count))) {
+        throw std::runtime_error("Capture file is truncated");
+    }
+}
+
+}  // namespace
+
+CaptureHeader CaptureHeader::fromModel(const KeyboardModel& model) {
+    CaptureHeader header;
+    header.name = model.name();
+    header.vendor_id = model.vendorId();
+    header.product_id = model.productId();
+    header.usage_page = model.interfaceUsagePage();
+    header.usage = model.interfaceUsage();
+    header.packet_length = static_cast<std::uint32_t>(model.packetLength());
+    header.key_count = model.keyCount();
+    header.chunks = model.reportChunks();
+    return header;
+}
+
+KeyboardModel CaptureHeader::toModel() const {
+    if (chunks.empty()) {
+        throw std::runtime_error("Capture header has no report layout");
+    }
+    KeyboardModel::LayoutRow row;
+    row.reserve(key_count);
+    for (std::size_t i = 0; i < key_count; ++i) {
+        row.push_back("K" + std::to_string(i));
+    }
+    KeyboardModel model(name, vendor_id, product_id, chunks.front().header, packet_length,
+                        {std::move(row)}, usage_page, usage);
+    try {
+        model.setReportChunks(chunks);
+    } catch (const std::invalid_argument& err) {
+        throw std::runtime_error(std::string("Capture header has an invalid report layout: ") + err.what());
+    }
+    return model;
+}
+
+CaptureWriter::CaptureWriter(const std::filesystem::path& path, const CaptureHeader& header)
+    : out_(path, std::ios::binary | std::ios::trunc) {
+    if (!out_) {
+        throw std::runtime_error("Failed to create capture file: " + path.string());
+    }
+    record_.assign(kMagic, kMagic + sizeof(kMagic));
+    putLe(record_, kVersion, 2);
+    putLe(record_, header.vendor_id, 2);
+    putLe(record_, header.product_id, 2);
+    putLe(record_, header.usage_page.value_or(0), 2);
+    putLe(record_, header.usage.value_or(0), 2);
+    putLe(record_, (header.usage_page ? kHasUsagePage : 0) | (header.usage ? kHasUsage : 0), 1);
+    putLe(record_, header.packet_length, 4);
+    const std::size_t name_len = std::min<std::size_t>(header.name.size(), 0xFFFF);
+    putLe(record_, name_len, 2);
+    record_.insert(record_.end(), header.name.begin(), header.name.begin() + static_cast<std::ptrdiff_t>(name_len));
+    putVarint(record_, header.key_count);
+    putVarint(record_, header.chunks.size());
+    for (const auto& chunk : header.chunks) {
+        putVarint(record_, chunk.header.size());
+        record_.insert(record_.end(), chunk.header.begin(), chunk.header.end());
+        putVarint(record_, chunk.first_key);
+        putVarint(record_, chunk.key_count);
+    }
+    out_.write(reinterpret_cast<const char*>(record_.data()), static_cast<std::streamsize>(record_.size()));
+    bytes_ += record_.size();
+}
+
+void CaptureWriter::append(std::chrono::microseconds timestamp, const std::vector<std::uint8_t>& payload) {
+    timestamp = std::max(timestamp, last_time_);
+    const bool key = frames_ == 0 || previous_.size() != payload.size() ||
+                     since_key_frame_ >= kKeyFrameInterval;
+
+    record_.clear();
+    record_.push_back(key ? kKeyFrame : kDeltaFrame);
+    putVarint(record_, static_cast<std::uint64_t>((timestamp - last_time_).count()));
+    putVarint(record_, payload.size());
+    if (key) {
+        record_.insert(record_.end(), payload.begin(), payload.end());
+        since_key_frame_ = 0;
+    } else {
+        std::size_t i = 0;
+        const std::size_t n = payload.size();
+        while (i < n) {
+            const std::size_t same_begin = i;
+            while (i < n && payload[i] == previous_[i]) ++i;
+            const std::size_t diff_begin = i;
+            while (i < n && payload[i] != previous_[i]) ++i;
+            putVarint(record_, diff_begin - same_begin);
+            putVarint(record_, i - diff_begin);
+            record_.insert(record_.end(),
+                           payload.begin() + static_cast<std::ptrdiff_t>(diff_begin),
+                           payload.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+        ++since_key_frame_;
+    }
+    out_.write(reinterpret_cast<const char*>(record_.data()), static_cast<std::streamsize>(record_.size()));
+    bytes_ += record_.size();
+    previous_.assign(payload.begin(), payload.end());
+    last_time_ = timestamp;
+    ++frames_;
+}
+
+void CaptureWriter::flush() {
+    out_.flush();
+}
+
+CaptureReader::CaptureReader(const std::filesystem::path& path)
+    : in_(path, std::ios::binary) {
+    if (!in_) {
+        throw std::runtime_error("Failed to open capture file: " + path.string());
+    }
+    char magic[sizeof(kMagic)] = {};
+    if (!in_.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+        throw std::runtime_error("Not a keyboard capture file: " + path.string());
+    }
+    const auto version = getLe(in_, 2);
+    if (version != kVersion) {
+        throw std::runtime_error("Unsupported capture version " + std::to_string(version));
+    }
+    header_.vendor_id = static_cast<std::uint16_t>(getLe(in_, 2));
+    header_.product_id = static_cast<std::uint16_t>(getLe(in_, 2));
+    const auto usage_page = static_cast<std::uint16_t>(getLe(in_, 2));
+    const auto usage = static_cast<std::uint16_t>(getLe(in_, 2));
+    const auto flags = getLe(in_, 1);
+    if (flags & kHasUsagePage) header_.usage_page = usage_page;
+    if (flags & kHasUsage) header_.usage = usage;
+    header_.packet_length = static_cast<std::uint32_t>(getLe(in_, 4));
+    header_.name.resize(static_cast<std::size_t>(getLe(in_, 2)));
+    readBytes(in_, reinterpret_cast<std::uint8_t*>(header_.name.data()), header_.name.size());
+    // Every key takes three bytes of some report, so a corrupt count cannot
+    // make the reader allocate wildly
+    header_.key_count = static_cast<std::size_t>(getVarint(in_));
+    const auto chunk_count = getVarint(in_);
+    if (chunk_count == 0 || chunk_count > 0xFFFF ||
+        header_.key_count > chunk_count * header_.packet_length) {
+        throw std::runtime_error("Capture file has a corrupt header");
+    }
+    for (std::uint64_t c = 0; c < chunk_count; ++c) {
+        KeyboardModel::ReportChunk chunk;
+        const auto header_size = getVarint(in_);
+        if (header_size > header_.packet_length) {
+            throw std::runtime_error("Capture file has a corrupt header");
+        }
+        chunk.header.resize(static_cast<std::size_t>(header_size));
+        readBytes(in_, chunk.header.data(), chunk.header.size());
+        chunk.first_key = static_cast<std::size_t>(getVarint(in_));
+        chunk.key_count = static_cast<std::size_t>(getVarint(in_));
+        header_.chunks.push_back(std::move(chunk));
+    }
+    payload_size_ = header_.chunks.size() * header_.packet_length;
+    data_start_ = in_.tellg();
+}
+
+bool CaptureReader::next() {
+    std::uint8_t kind = 0;
+    if (!getByte(in_, kind)) {
+        return false;
+    }
+    time_ += std::chrono::microseconds(static_cast<std::int64_t>(getVarint(in_)));
+    const auto size = getVarint(in_);
+    if (kind == kKeyFrame) {
+        // Checked before resizing, as the size comes straight from the file
+        if (size != payload_size_) {
+            throw std::runtime_error("Capture file has a corrupt record");
+        }
+        payload_.resize(payload_size_);
+        readBytes(in_, payload_.data(), payload_size_);
+        return true;
+    }
+    // A delta needs a key frame before it
+    if (kind != kDeltaFrame || size != payload_size_ || payload_.size() != payload_size_) {
+        throw std::runtime_error("Capture file has a corrupt record");
+    }
+    std::size_t i = 0;
+    while (i < payload_size_) {
+        const auto same = getVarint(in_);
+        const auto changed = getVarint(in_);
+        if (same > payload_size_ - i || changed > payload_size_ - i - same) {
+            throw std::runtime_error("Capture file has a corrupt record");
+        }
+        i += static_cast<std::size_t>(same);
+        readBytes(in_, payload_.data() + i, static_cast<std::size_t>(changed));
+        i += static_cast<std::size_t>(changed);
+    }
+    return true;
+}
+
+void CaptureReader::rewind() {
+    in_.clear();
+    in_.seekg(data_start_);
+    payload_.clear();
+    time_ = std::chrono::microseconds{0};
+}
+
+}  // namespace kb::cfg
@@ -0,0 +1,46 @@
+#include "keyboard_configurator/frame_mailbox.hpp"
+
+namespace kb::cfg {
+
+bool FrameMailbox::post(std::vector<std::uint8_t>& payload, bool force) {
+    bool replaced = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        replaced = full_;
+        force_ = (replaced && force_) || force;
+        slot_.swap(payload);
+        full_ = true;
+    }
+    cv_.notify_one();
+    return replaced;
+}
+
+bool FrameMailbox::take(std::vector<std::uint8_t>& payload, bool& force) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return full_ || closed_; });
+    if (!full_) {
+        return false;
+    }
+    slot_.swap(payload);
+    force = force_;
+    full_ = false;
+    force_ = false;
+    return true;
+}
+
+void FrameMailbox::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+void FrameMailbox::reopen() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+    full_ = false;
+    force_ = false;
+}
+
+}  // namespace kb::cfg
@@ -0,0 +1,94 @@
+#include "keyboard_configurator/frame_scheduler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <thread>
+
+namespace kb::cfg {
+
+namespace {
+
+double toMs(FrameScheduler::Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+}  // namespace
+
+std::optional<OverrunPolicy> parseOverrunPolicy(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (lower == "skip") return OverrunPolicy::Skip;
+    if (lower == "catch_up" || lower == "catchup") return OverrunPolicy::CatchUp;
+    return std::nullopt;
+}
+
+FrameScheduler::FrameScheduler(std::chrono::milliseconds period, OverrunPolicy policy)
+    : period_(std::max(std::chrono::milliseconds{1}, period)), policy_(policy) {
+    reset(Clock::now());
+}
+
+void FrameScheduler::reset(Clock::time_point start) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    next_deadline_ = start;
+    has_last_wake_ = false;
+}
+
+void FrameScheduler::setPeriod(std::chrono::milliseconds period) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    period_ = std::max(std::chrono::milliseconds{1}, period);
+}
+
+void FrameScheduler::setPolicy(OverrunPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    policy_ = policy;
+}
+
+FrameScheduler::Clock::time_point FrameScheduler::waitNext() {
+    Clock::time_point deadline;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto now = Clock::now();
+        if (now - next_deadline_ >= period_) {
+            // Whole periods went by while rendering; resync per policy
+            ++stats_.overruns;
+            const auto missed = static_cast<std::int64_t>((now - next_deadline_) / period_);
+            const auto drop = policy_ == OverrunPolicy::Skip
+                ? missed
+                : std::max<std::int64_t>(0, missed - kMaxCatchUpFrames);
+            next_deadline_ += period_ * drop;
+            stats_.skipped_frames += static_cast<std::uint64_t>(drop);
+        }
+        deadline = next_deadline_;
+        next_deadline_ += period_;
+    }
+
+    std::this_thread::sleep_until(deadline);
+    const auto woke = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.frames;
+    if (has_last_wake_) {
+        const double period_ms = toMs(woke - last_wake_);
+        const double jitter_ms = std::abs(period_ms - toMs(period_));
+        ++period_samples_;
+        period_sum_ms_ += period_ms;
+        jitter_sum_ms_ += jitter_ms;
+        stats_.last_period_ms = period_ms;
+        stats_.mean_period_ms = period_sum_ms_ / static_cast<double>(period_samples_);
+        stats_.mean_jitter_ms = jitter_sum_ms_ / static_cast<double>(period_samples_);
+        stats_.max_jitter_ms = std::max(stats_.max_jitter_ms, jitter_ms);
+    }
+    last_wake_ = woke;
+    has_last_wake_ = true;
+    return deadline;
+}
+
+FrameScheduler::Stats FrameScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace kb::cfg
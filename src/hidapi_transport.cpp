@@ -9,6 +9,11 @@ namespace kb::cfg {
 
 namespace {
 
+// hid_init/hid_exit are process-wide while transports are per keyboard:
+// initialise for the first transport that connects, exit after the last
+std::mutex hid_library_mutex;
+std::size_t hid_library_users = 0;
+
 std::string narrowError(hid_device* device) {
     const wchar_t* werror = hid_error(device);
     if (werror == nullptr) {
@@ -57,7 +62,12 @@ HidapiTransport::HidapiTransport() = default;
 
 HidapiTransport::~HidapiTransport() {
     handle_.reset();
-    hid_exit();
+    if (initialized_) {
+        std::lock_guard<std::mutex> lock(hid_library_mutex);
+        if (--hid_library_users == 0) {
+            hid_exit();
+        }
+    }
 }
 
 std::string HidapiTransport::id() const {
@@ -65,14 +75,16 @@ std::string HidapiTransport::id() const {
 }
 
 bool HidapiTransport::ensureInitialized() {
-    static bool initialized = false;
-    if (!initialized) {
-        if (hid_init() != 0) {
-            std::cerr << "[HidapiTransport] hid_init failed" << '\n';
-            return false;
-        }
-        initialized = true;
+    if (initialized_) {
+        return true;
     }
+    std::lock_guard<std::mutex> lock(hid_library_mutex);
+    if (hid_library_users == 0 && hid_init() != 0) {
+        std::cerr << "[HidapiTransport] hid_init failed" << '\n';
+        return false;
+    }
+    ++hid_library_users;
+    initialized_ = true;
     return true;
 }
 
@@ -134,16 +146,41 @@ bool HidapiTransport::connect(const KeyboardModel& model) {
 
 bool HidapiTransport::sendFrame(const KeyboardModel& model,
                                 const std::vector<std::uint8_t>& payload) {
+    // No dirty entries means every report
+    return sendReports(model, payload, {});
+}
+
+bool HidapiTransport::sendReports(const KeyboardModel& model,
+                                  const std::vector<std::uint8_t>& payload,
+                                  const std::vector<std::uint8_t>& dirty) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (!handle_) {
         std::cerr << "[HidapiTransport] sendFrame called before connect" << '\n';
         return false;
     }
 
-    int res = hid_send_feature_report(handle_.get(), payload.data(), static_cast<int>(payload.size()));
+    const std::size_t report_size = model.packetLength();
+    if (report_size == 0 || payload.size() % report_size != 0) {
+        // Not a chunked payload; send it as one report
+        return sendReport(model, payload.data(), payload.size());
+    }
+    const std::size_t reports = payload.size() / report_size;
+    for (std::size_t r = 0; r < reports; ++r) {
+        if (r < dirty.size() && dirty[r] == 0) {
+            continue;
+        }
+        if (!sendReport(model, payload.data() + r * report_size, report_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HidapiTransport::sendReport(const KeyboardModel& model, const std::uint8_t* data, std::size_t size) {
+    int res = hid_send_feature_report(handle_.get(), data, size);
     if (res < 0) {
         std::cerr << "[HidapiTransport] send_feature_report failed for "
-                  << model.name() << " (" << payload.size() << " bytes): "
+                  << model.name() << " (" << size << " bytes): "
                   << narrowError(handle_.get()) << '\n';
         return false;
     }
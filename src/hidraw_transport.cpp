@@ -0,0 +1,247 @@
+#include "keyboard_configurator/hidraw_transport.hpp"
+
+#include <linux/hidraw.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+
+#include "keyboard_configurator/keyboard_model.hpp"
+
+namespace kb::cfg {
+
+namespace {
+
+struct HidrawInfo {
+    std::string node;
+    std::uint16_t vendor_id{0};
+    std::uint16_t product_id{0};
+    std::optional<std::uint16_t> usage_page;
+    std::optional<std::uint16_t> usage;
+};
+
+// HID_ID=<bus>:<vendor>:<product>, all hex
+bool readIds(const std::filesystem::path& uevent, HidrawInfo& info) {
+    std::ifstream in(uevent);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("HID_ID=", 0) != 0) {
+            continue;
+        }
+        unsigned bus = 0;
+        unsigned vendor = 0;
+        unsigned product = 0;
+        if (std::sscanf(line.c_str() + 7, "%x:%x:%x", &bus, &vendor, &product) != 3) {
+            return false;
+        }
+        info.vendor_id = static_cast<std::uint16_t>(vendor);
+        info.product_id = static_cast<std::uint16_t>(product);
+        return true;
+    }
+    return false;
+}
+
+// Usage page and usage of the first top-level collection, which is what
+// hidapi reports for an interface.
+void readTopLevelUsage(const std::filesystem::path& descriptor_path, HidrawInfo& info) {
+    std::ifstream in(descriptor_path, std::ios::binary);
+    const std::vector<std::uint8_t> desc((std::istreambuf_iterator<char>(in)),
+                                         std::istreambuf_iterator<char>());
+    std::size_t i = 0;
+    while (i < desc.size()) {
+        const std::uint8_t prefix = desc[i];
+        if (prefix == 0xFE) {
+            // Long item: size byte, tag byte, data
+            if (i + 1 >= desc.size()) {
+                return;
+            }
+            i += 3 + desc[i + 1];
+            continue;
+        }
+        static constexpr std::size_t kSizes[4] = {0, 1, 2, 4};
+        const std::size_t size = kSizes[prefix & 0x03];
+        if (i + 1 + size > desc.size()) {
+            return;
+        }
+        std::uint32_t value = 0;
+        for (std::size_t b = 0; b < size; ++b) {
+            value |= static_cast<std::uint32_t>(desc[i + 1 + b]) << (8 * b);
+        }
+        switch (prefix & 0xFC) {
+        case 0x04:  // Usage Page (global)
+            info.usage_page = static_cast<std::uint16_t>(value);
+            break;
+        case 0x08:  // Usage (local); a 4-byte usage carries its own page
+            if (size == 4) {
+                info.usage_page = static_cast<std::uint16_t>(value >> 16);
+            }
+            info.usage = static_cast<std::uint16_t>(value);
+            break;
+        case 0xA0:  // Collection
+            return;
+        default:
+            break;
+        }
+        i += 1 + size;
+    }
+}
+
+std::vector<HidrawInfo> listHidraw() {
+    std::vector<HidrawInfo> result;
+    const std::filesystem::path root("/sys/class/hidraw");
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+        HidrawInfo info;
+        const auto device = entry.path() / "device";
+        if (!readIds(device / "uevent", info)) {
+            continue;
+        }
+        readTopLevelUsage(device / "report_descriptor", info);
+        info.node = "/dev/" + entry.path().filename().string();
+        result.push_back(std::move(info));
+    }
+    std::sort(result.begin(), result.end(), [](const HidrawInfo& a, const HidrawInfo& b) {
+        return a.node < b.node;
+    });
+    return result;
+}
+
+// Same rules as the hidapi transport
+bool matchesUsage(const HidrawInfo& info, const KeyboardModel& model) {
+    const auto desired_page = model.interfaceUsagePage();
+    const auto desired_usage = model.interfaceUsage();
+    if (!desired_page.has_value() && !desired_usage.has_value()) {
+        return info.usage_page == 0xFF00 && info.usage == 0x0001;
+    }
+    if (desired_page.has_value() && info.usage_page != desired_page) {
+        return false;
+    }
+    if (desired_usage.has_value() && info.usage != desired_usage) {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+HidrawTransport::~HidrawTransport() {
+    closeDevice();
+}
+
+std::string HidrawTransport::id() const {
+    return "hidraw";
+}
+
+void HidrawTransport::closeDevice() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool HidrawTransport::connect(const KeyboardModel& model) {
+    closeDevice();
+
+    const HidrawInfo* selected = nullptr;
+    const HidrawInfo* fallback = nullptr;
+    const auto nodes = listHidraw();
+    for (const auto& info : nodes) {
+        if (info.vendor_id != model.vendorId() || info.product_id != model.productId()) {
+            continue;
+        }
+        if (fallback == nullptr) {
+            fallback = &info;
+        }
+        if (matchesUsage(info, model)) {
+            selected = &info;
+            break;
+        }
+    }
+    if (selected == nullptr) {
+        // Fall back to the first interface, as the hidapi transport does
+        selected = fallback;
+    }
+    if (selected == nullptr) {
+        std::cerr << "[HidrawTransport] No hidraw node for device (VID="
+                  << std::hex << model.vendorId()
+                  << ", PID=" << model.productId() << std::dec << ")" << '\n';
+        return false;
+    }
+
+    fd_ = ::open(selected->node.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) {
+        std::cerr << "[HidrawTransport] Unable to open " << selected->node << ": "
+                  << std::strerror(errno) << '\n';
+        return false;
+    }
+    node_ = selected->node;
+    buffer_.assign(std::max<std::size_t>(model.packetLength(), 1), 0);
+    std::cout << "[HidrawTransport] Connected to keyboard: " << model.name()
+              << " (" << node_ << ")" << '\n';
+    return true;
+}
+
+bool HidrawTransport::sendFrame(const KeyboardModel& model,
+                                const std::vector<std::uint8_t>& payload) {
+    // No dirty entries means every report
+    return sendReports(model, payload, {});
+}
+
+bool HidrawTransport::sendReports(const KeyboardModel& model,
+                                  const std::vector<std::uint8_t>& payload,
+                                  const std::vector<std::uint8_t>& dirty) {
+    const std::size_t report_size = model.packetLength();
+    if (fd_ < 0) {
+        std::cerr << "[HidrawTransport] sendFrame called before connect" << '\n';
+        return false;
+    }
+    if (report_size == 0 || payload.size() % report_size != 0) {
+        return sendReport(payload.data(), payload.size());
+    }
+    const std::size_t reports = payload.size() / report_size;
+    for (std::size_t r = 0; r < reports; ++r) {
+        if (r < dirty.size() && dirty[r] == 0) {
+            continue;
+        }
+        if (!sendReport(payload.data() + r * report_size, report_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HidrawTransport::sendReport(const std::uint8_t* data, std::size_t size) {
+    // HIDIOCSFEATURE takes a mutable buffer; the first byte is the report ID
+    if (buffer_.size() < size) {
+        buffer_.resize(size);
+    }
+    std::copy_n(data, size, buffer_.data());
+    int res = 0;
+    do {
+        res = ::ioctl(fd_, HIDIOCSFEATURE(size), buffer_.data());
+    } while (res < 0 && errno == EINTR);
+    if (res < 0) {
+        // Saved first: the stream calls below may change errno
+        const int err = errno;
+        std::cerr << "[HidrawTransport] HIDIOCSFEATURE failed on " << node_
+                  << " (" << size << " bytes): " << std::strerror(err) << '\n';
+        if (err == ENODEV || err == EIO) {
+            // Unplugged; a later connect reopens the node
+            closeDevice();
+        }
+        return false;
+    }
+    return true;
+}
+
+}  // namespace kb::cfg
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -26,15 +27,23 @@ std::string getenv_or(const char* key, const char* fallback) {
 }
 }
 
-HyprlandWatcher::HyprlandWatcher(HyprConfig cfg, ConfiguratorCLI& cli, std::size_t preset_count)
-    : cfg_(std::move(cfg)), cli_(cli), preset_count_(preset_count) {}
+HyprlandWatcher::HyprlandWatcher(HyprConfig cfg, ConfiguratorCLI& cli, std::size_t preset_count) {
+    addTarget(std::move(cfg), cli, preset_count);
+}
 
 HyprlandWatcher::~HyprlandWatcher() { stop(); }
 
+void HyprlandWatcher::addTarget(HyprConfig cfg, ConfiguratorCLI& cli, std::size_t preset_count,
+                                ClassCallback on_class) {
+    targets_.push_back({std::move(cfg), &cli, preset_count, std::move(on_class)});
+}
+
 void HyprlandWatcher::start() {
     if (thread_.joinable()) return;
     stop_.store(false);
-    std::string sock = cfg_.events_socket.empty() ? autoDetectEventsSocket() : cfg_.events_socket;
+    // One compositor, one socket: the first keyboard's setting decides
+    const auto& cfg = targets_.front().cfg;
+    std::string sock = cfg.events_socket.empty() ? autoDetectEventsSocket() : cfg.events_socket;
     thread_ = std::thread(&HyprlandWatcher::runLoop, this, sock);
 }
 
@@ -45,6 +54,58 @@ void HyprlandWatcher::stop() {
     }
 }
 
+void HyprlandWatcher::applyClass(Target& target, const std::string& app_class) {
+    bool shortcuts_engaged = false;
+    if (target.on_class) {
+        shortcuts_engaged = target.on_class(app_class);
+    }
+
+    // If shortcuts are engaged, DO NOT update the profile here.
+    // The ShortcutWatcher will handle restoring the correct profile
+    // when the shortcuts are disengaged.
+    if (shortcuts_engaged) {
+        return;
+    }
+
+    // --- Painter's Algorithm Logic ---
+    const auto& cfg = target.cfg;
+    if (cfg.profile_draw_order.empty()) {
+        return;
+    }
+    std::string prof;
+    auto pit = cfg.class_to_profile.find(app_class);
+    if (pit != cfg.class_to_profile.end()) {
+        prof = pit->second;
+    } else {
+        prof = cfg.default_profile;
+    }
+
+    auto oit = cfg.profile_draw_order.find(prof);
+    auto mit = cfg.profile_masks.find(prof);
+    if (oit == cfg.profile_draw_order.end() || mit == cfg.profile_masks.end()) {
+        return;
+    }
+
+    // 1. Get the ordered playlist
+    const std::vector<std::size_t>& draw_list = oit->second;
+
+    // 2. Get the masks, shared as loaded. Only a set built for a different
+    //    preset count is padded, which costs a copy.
+    MaskSetPtr masks = mit->second;
+    if (masks && masks->size() != target.preset_count) {
+        auto resized = std::make_shared<MaskSet>(*masks);
+        resized->resize(target.preset_count);
+        masks = std::move(resized);
+    }
+
+    // 3. Publish masks and draw list together so no frame mixes profiles
+    target.cli->updateScene([&](Scene& scene) {
+        scene.masks = std::move(masks);
+        scene.draw_list = draw_list;
+    });
+    target.cli->refreshRender();
+}
+
 std::string HyprlandWatcher::autoDetectEventsSocket() {
     std::string sig = getenv_or("HYPRLAND_INSTANCE_SIGNATURE", "");
     if (sig.empty()) return {};
@@ -127,48 +188,9 @@ void HyprlandWatcher::runLoop(std::string socket_path) {
                         continue; 
                     }
                     last_class_ = appClass;
-                    
-                    bool shortcuts_engaged = false;
-                    if (on_class_) { 
-                        shortcuts_engaged = on_class_(last_class_); 
-                    }
-
-                    // If shortcuts are engaged, DO NOT update the profile here.
-                    // The ShortcutWatcher will handle restoring the correct profile
-                    // when the shortcuts are disengaged.
-                    if (shortcuts_engaged) {
-                        continue;
-                    }
 
-                    // --- Painter's Algorithm Logic ---
-                    if (!cfg_.profile_draw_order.empty()) {
-                        std::string prof;
-                        auto pit = cfg_.class_to_profile.find(appClass);
-                        if (pit != cfg_.class_to_profile.end()) {
-                            prof = pit->second;
-                        } else {
-                            prof = cfg_.default_profile;
-                        }
-
-                        auto oit = cfg_.profile_draw_order.find(prof);
-                        auto mit = cfg_.profile_masks.find(prof);
-
-                        if (oit != cfg_.profile_draw_order.end() && mit != cfg_.profile_masks.end()) {
-                            // 1. Get the ordered playlist
-                            const std::vector<std::size_t>& draw_list = oit->second;
-                            
-                            // 2. Get the masks (ensure size safety)
-                            std::vector<std::vector<bool>> masks = mit->second;
-                            if (masks.size() != preset_count_) {
-                                masks.resize(preset_count_, std::vector<bool>());
-                            }
-
-                            // 3. Apply to CLI -> Engine
-                            cli_.applyPresetMasks(masks);
-                            cli_.setDrawList(draw_list); // Calls the new Painter's Algo method
-                            cli_.refreshRender();
-                            continue;
-                        }
+                    for (auto& target : targets_) {
+                        applyClass(target, appClass);
                     }
                 }
             }
@@ -21,9 +21,14 @@ void KeyActivityProvider::recordKeyPress(std::size_t key_index, double intensity
         return;
     }
     const double t = nowSeconds();
-    std::lock_guard<std::mutex> lock(mutex_);
-    events_.push_back(Event{key_index, t, intensity});
-    pruneStaleEvents(t);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back(Event{key_index, t, intensity});
+        pruneStaleEvents(t);
+        last_activity_ = t;
+        ++generation_;
+    }
+    activity_cv_.notify_all();
 }
 
 std::vector<KeyActivityProvider::Event> KeyActivityProvider::recentEvents(double window_seconds) const {
@@ -41,6 +46,30 @@ std::vector<KeyActivityProvider::Event> KeyActivityProvider::recentEvents(double
     return out;
 }
 
+double KeyActivityProvider::lastActivitySeconds() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_activity_;
+}
+
+std::uint64_t KeyActivityProvider::activityGeneration() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+bool KeyActivityProvider::waitForActivity(std::uint64_t seen,
+                                          std::chrono::steady_clock::time_point deadline) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return activity_cv_.wait_until(lock, deadline, [&] { return generation_ != seen; });
+}
+
+void KeyActivityProvider::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+    }
+    activity_cv_.notify_all();
+}
+
 double KeyActivityProvider::nowSeconds() const {
     using namespace std::chrono;
     return duration<double>(steady_clock::now() - start_time_).count();
@@ -5,6 +5,7 @@
 #include <libevdev/libevdev.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 
 #include <chrono>
 #include <iostream>
@@ -12,17 +13,26 @@
 namespace kb::cfg {
 
 KeyActivityWatcher::KeyActivityWatcher(const KeyboardModel& model,
-                                       KeyActivityProviderPtr provider)
-    : model_(model), provider_(std::move(provider)) {}
+                                       KeyActivityProviderPtr provider) {
+    addTarget(model, std::move(provider));
+}
 
 KeyActivityWatcher::~KeyActivityWatcher() { stop(); }
 
+void KeyActivityWatcher::addTarget(const KeyboardModel& model,
+                                   KeyActivityProviderPtr provider) {
+    if (!provider) return;
+    targets_.push_back({&model, std::move(provider)});
+}
+
 void KeyActivityWatcher::start() {
-    if (!provider_) return;
+    if (targets_.empty()) return;
     if (thread_.joinable()) return;
     stop_.store(false);
     openDevices();
-    provider_->setKeyCount(model_.keyCount());
+    for (auto& t : targets_) {
+        t.provider->setKeyCount(t.model->keyCount());
+    }
     thread_ = std::thread(&KeyActivityWatcher::runLoop, this);
 }
 
@@ -55,7 +65,15 @@ void KeyActivityWatcher::openDevices() {
             ::close(fd);
             continue;
         }
-        devices_.push_back({fd, dev});
+        DevHandle handle{fd, dev, {}};
+        const auto vid = libevdev_get_id_vendor(dev);
+        const auto pid = libevdev_get_id_product(dev);
+        for (std::size_t i = 0; i < targets_.size(); ++i) {
+            if (targets_[i].model->vendorId() == vid && targets_[i].model->productId() == pid) {
+                handle.targets.push_back(i);
+            }
+        }
+        devices_.push_back(std::move(handle));
     }
 }
 
@@ -73,8 +91,29 @@ void KeyActivityWatcher::closeDevices() {
     devices_.clear();
 }
 
+void KeyActivityWatcher::recordPress(const Target& target, unsigned int code) {
+    if (auto idx = target.model->indexForKeycode(static_cast<int>(code))) {
+        target.provider->recordKeyPress(*idx, 1.0);
+    }
+}
+
 void KeyActivityWatcher::runLoop() {
+    // Block in poll() rather than sleeping between scans so a key press reaches
+    // the provider (and wakes an idle render loop) as soon as it arrives. The
+    // timeout only bounds how long stop() waits.
+    std::vector<pollfd> fds;
+    for (const auto& d : devices_) {
+        if (d.dev) fds.push_back({d.fd, POLLIN, 0});
+    }
+
     while (!stop_.load()) {
+        if (fds.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (::poll(fds.data(), fds.size(), 100) <= 0) {
+            continue;
+        }
         for (auto& d : devices_) {
             if (!d.dev) continue;
             while (!stop_.load()) {
@@ -82,9 +121,10 @@ void KeyActivityWatcher::runLoop() {
                 int rc = libevdev_next_event(d.dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
                 if (rc == 0) {
                     if (ev.type == EV_KEY && ev.value == 1) { // key press
-                        auto idx = model_.indexForKeycode(ev.code);
-                        if (idx) {
-                            provider_->recordKeyPress(*idx, 1.0);
+                        if (d.targets.empty()) {
+                            for (const auto& t : targets_) recordPress(t, ev.code);
+                        } else {
+                            for (auto i : d.targets) recordPress(targets_[i], ev.code);
                         }
                     }
                 } else if (rc == -EAGAIN || rc == LIBEVDEV_READ_STATUS_SYNC || rc == -EINTR) {
@@ -94,7 +134,6 @@ void KeyActivityWatcher::runLoop() {
                 }
             }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
 
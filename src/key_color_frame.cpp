@@ -1,5 +1,6 @@
 #include "keyboard_configurator/key_color_frame.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace kb::cfg {
@@ -18,10 +19,22 @@ RgbColor KeyColorFrame::color(std::size_t index) const {
     return colors_[index];
 }
 
-void KeyColorFrame::fill(RgbColor color) {
-    for (auto& entry : colors_) {
-        entry = color;
+ColorSpan KeyColorFrame::span(std::size_t key_count) {
+    if (key_count > colors_.size()) {
+        throw std::out_of_range("KeyColorFrame::span frame smaller than key count");
+    }
+    return {colors_.data(), key_count};
+}
+
+ConstColorSpan KeyColorFrame::span(std::size_t key_count) const {
+    if (key_count > colors_.size()) {
+        throw std::out_of_range("KeyColorFrame::span frame smaller than key count");
     }
+    return {colors_.data(), key_count};
+}
+
+void KeyColorFrame::fill(RgbColor color) {
+    std::fill(colors_.begin(), colors_.end(), color);
 }
 
 }  // namespace kb::cfg
@@ -0,0 +1,184 @@
+#include "keyboard_configurator/key_geometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace kb::cfg {
+
+void SpatialIndex::build(const std::vector<double>& xs,
+                         const std::vector<double>& ys,
+                         const std::vector<std::uint8_t>& include) {
+    points_.clear();
+    cell_start_.clear();
+    cols_ = rows_ = 0;
+
+    const std::size_t total = std::min(xs.size(), ys.size());
+    std::vector<Point> points;
+    points.reserve(total);
+    double max_x = -std::numeric_limits<double>::infinity();
+    double max_y = -std::numeric_limits<double>::infinity();
+    min_x_ = std::numeric_limits<double>::infinity();
+    min_y_ = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < total; ++i) {
+        if (!include.empty() && (i >= include.size() || include[i] == 0)) {
+            continue;
+        }
+        points.push_back({xs[i], ys[i], i});
+        min_x_ = std::min(min_x_, xs[i]);
+        min_y_ = std::min(min_y_, ys[i]);
+        max_x = std::max(max_x, xs[i]);
+        max_y = std::max(max_y, ys[i]);
+    }
+    if (points.empty()) {
+        return;
+    }
+
+    // About one point per cell
+    const auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(points.size()))));
+    cols_ = rows_ = std::max<std::size_t>(side, 1);
+    cell_w_ = std::max((max_x - min_x_) / static_cast<double>(cols_), 1e-9);
+    cell_h_ = std::max((max_y - min_y_) / static_cast<double>(rows_), 1e-9);
+
+    // Counting sort into cells
+    cell_start_.assign(cols_ * rows_ + 1, 0);
+    for (const auto& p : points) {
+        ++cell_start_[cellY(p.y) * cols_ + cellX(p.x) + 1];
+    }
+    for (std::size_t c = 1; c < cell_start_.size(); ++c) {
+        cell_start_[c] += cell_start_[c - 1];
+    }
+    points_.resize(points.size());
+    std::vector<std::size_t> fill(cell_start_.begin(), cell_start_.end() - 1);
+    for (const auto& p : points) {
+        points_[fill[cellY(p.y) * cols_ + cellX(p.x)]++] = p;
+    }
+}
+
+std::size_t SpatialIndex::cellX(double x) const noexcept {
+    const double c = std::floor((x - min_x_) / cell_w_);
+    return static_cast<std::size_t>(std::clamp(c, 0.0, static_cast<double>(cols_ - 1)));
+}
+
+std::size_t SpatialIndex::cellY(double y) const noexcept {
+    const double c = std::floor((y - min_y_) / cell_h_);
+    return static_cast<std::size_t>(std::clamp(c, 0.0, static_cast<double>(rows_ - 1)));
+}
+
+template <typename Fn>
+void SpatialIndex::forEachInRadius(double x, double y, double radius, Fn&& fn) const {
+    if (points_.empty() || !(radius >= 0.0)) {
+        return;
+    }
+    const std::size_t x0 = cellX(x - radius);
+    const std::size_t x1 = cellX(x + radius);
+    const std::size_t y0 = cellY(y - radius);
+    const std::size_t y1 = cellY(y + radius);
+    const double r2 = radius * radius;
+    for (std::size_t cy = y0; cy <= y1; ++cy) {
+        for (std::size_t cx = x0; cx <= x1; ++cx) {
+            const std::size_t cell = cy * cols_ + cx;
+            for (std::size_t i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i) {
+                const double dx = points_[i].x - x;
+                const double dy = points_[i].y - y;
+                const double d2 = dx * dx + dy * dy;
+                if (d2 <= r2) {
+                    fn(points_[i], d2);
+                }
+            }
+        }
+    }
+}
+
+void SpatialIndex::queryRadius(double x, double y, double radius, std::vector<std::size_t>& out) const {
+    out.clear();
+    forEachInRadius(x, y, radius, [&out](const Point& p, double) { out.push_back(p.index); });
+}
+
+void SpatialIndex::nearest(double x, double y, std::size_t k, std::vector<std::size_t>& out) const {
+    out.clear();
+    k = std::min(k, points_.size());
+    if (k == 0) {
+        return;
+    }
+    // Grow the search radius until it holds k points; anything closer than
+    // the k-th of those is inside the radius too. Cell lookups clamp to the
+    // grid, so a large enough radius always reaches every point.
+    std::vector<std::pair<double, std::size_t>> ranked;
+    double radius = std::max(cell_w_, cell_h_);
+    for (;;) {
+        ranked.clear();
+        forEachInRadius(x, y, radius, [&ranked](const Point& p, double d2) {
+            ranked.emplace_back(d2, p.index);
+        });
+        if (ranked.size() >= k) {
+            break;
+        }
+        radius *= 2.0;
+    }
+    std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(k), ranked.end());
+    for (std::size_t i = 0; i < k; ++i) {
+        out.push_back(ranked[i].second);
+    }
+}
+
+KeyGeometry::KeyGeometry(std::vector<KeyRect> rects, const std::vector<std::string>& labels)
+    : rects_(std::move(rects)) {
+    const std::size_t total = rects_.size();
+    xs_.assign(total, 0.0);
+    ys_.assign(total, 0.0);
+    uniform_xs_.assign(total, 0.0);
+    uniform_ys_.assign(total, 0.0);
+    if (total == 0) {
+        return;
+    }
+
+    double min_cx = std::numeric_limits<double>::infinity();
+    double min_cy = min_cx;
+    double max_cx = -min_cx;
+    double max_cy = -min_cx;
+    double left = min_cx;
+    double top = min_cx;
+    double right = -min_cx;
+    double bottom = -min_cx;
+    for (const auto& rect : rects_) {
+        min_cx = std::min(min_cx, rect.centerX());
+        max_cx = std::max(max_cx, rect.centerX());
+        min_cy = std::min(min_cy, rect.centerY());
+        max_cy = std::max(max_cy, rect.centerY());
+        left = std::min(left, rect.x);
+        right = std::max(right, rect.x + rect.width);
+        top = std::min(top, rect.y);
+        bottom = std::max(bottom, rect.y + rect.height);
+    }
+
+    const double span_x = max_cx - min_cx;
+    const double span_y = max_cy - min_cy;
+    const double extent = std::max({right - left, bottom - top, 1e-9});
+    std::vector<std::uint8_t> lit(total, 1);
+    for (std::size_t i = 0; i < total; ++i) {
+        const auto& rect = rects_[i];
+        xs_[i] = span_x > 0.0 ? (rect.centerX() - min_cx) / span_x : 0.0;
+        ys_[i] = span_y > 0.0 ? (rect.centerY() - min_cy) / span_y : 0.0;
+        uniform_xs_[i] = (rect.centerX() - min_cx) / extent;
+        uniform_ys_[i] = (rect.centerY() - min_cy) / extent;
+        if (i < labels.size() && labels[i] == "NAN") {
+            lit[i] = 0;
+        }
+    }
+    index_.build(xs_, ys_, lit);
+}
+
+KeyGeometry KeyGeometry::fromLayout(const std::vector<std::vector<std::string>>& layout) {
+    std::vector<KeyRect> rects;
+    std::vector<std::string> labels;
+    for (std::size_t r = 0; r < layout.size(); ++r) {
+        for (std::size_t c = 0; c < layout[r].size(); ++c) {
+            rects.push_back({static_cast<double>(c), static_cast<double>(r), 1.0, 1.0});
+            labels.push_back(layout[r][c]);
+        }
+    }
+    return KeyGeometry(std::move(rects), labels);
+}
+
+}  // namespace kb::cfg
@@ -0,0 +1,140 @@
+#include "keyboard_configurator/key_mask.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace kb::cfg {
+
+namespace {
+
+constexpr std::size_t kWordBits = 64;
+
+std::size_t wordCount(std::size_t bits) {
+    return (bits + kWordBits - 1) / kWordBits;
+}
+
+}  // namespace
+
+KeyMask::KeyMask(std::size_t key_count, bool value) {
+    assign(key_count, value);
+}
+
+bool KeyMask::test(std::size_t index) const {
+    if (index >= size_) {
+        throw std::out_of_range("KeyMask::test index out of range");
+    }
+    return (words_[index / kWordBits] >> (index % kWordBits)) & 1u;
+}
+
+void KeyMask::set(std::size_t index, bool value) {
+    if (index >= size_) {
+        throw std::out_of_range("KeyMask::set index out of range");
+    }
+    const std::uint64_t bit = std::uint64_t{1} << (index % kWordBits);
+    auto& word = words_[index / kWordBits];
+    word = value ? (word | bit) : (word & ~bit);
+    indices_valid_ = false;
+}
+
+void KeyMask::assign(std::size_t key_count, bool value) {
+    size_ = key_count;
+    words_.assign(wordCount(key_count), value ? ~std::uint64_t{0} : 0);
+    clearTail();
+    indices_valid_ = false;
+}
+
+void KeyMask::fill(bool value) {
+    std::fill(words_.begin(), words_.end(), value ? ~std::uint64_t{0} : 0);
+    clearTail();
+    indices_valid_ = false;
+}
+
+std::size_t KeyMask::count() const noexcept {
+    std::size_t total = 0;
+    for (auto word : words_) {
+        total += static_cast<std::size_t>(__builtin_popcountll(word));
+    }
+    return total;
+}
+
+bool KeyMask::any() const noexcept {
+    return std::any_of(words_.begin(), words_.end(), [](std::uint64_t w) { return w != 0; });
+}
+
+KeyMask& KeyMask::operator|=(const KeyMask& other) {
+    requireSameSize(other, "operator|=");
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+        words_[w] |= other.words_[w];
+    }
+    indices_valid_ = false;
+    return *this;
+}
+
+KeyMask& KeyMask::operator&=(const KeyMask& other) {
+    requireSameSize(other, "operator&=");
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+        words_[w] &= other.words_[w];
+    }
+    indices_valid_ = false;
+    return *this;
+}
+
+KeyMask& KeyMask::andNot(const KeyMask& other) {
+    requireSameSize(other, "andNot");
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+        words_[w] &= ~other.words_[w];
+    }
+    indices_valid_ = false;
+    return *this;
+}
+
+bool KeyMask::operator==(const KeyMask& other) const noexcept {
+    return size_ == other.size_ && words_ == other.words_;
+}
+
+const std::vector<std::size_t>& KeyMask::indices() const {
+    if (indices_valid_) {
+        return indices_;
+    }
+    indices_.clear();
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+        std::uint64_t word = words_[w];
+        while (word != 0) {
+            const auto bit = static_cast<std::size_t>(__builtin_ctzll(word));
+            indices_.push_back(w * kWordBits + bit);
+            word &= word - 1;
+        }
+    }
+    indices_valid_ = true;
+    return indices_;
+}
+
+void KeyMask::select(std::uint8_t* dst, std::uint8_t on, std::uint8_t off) const noexcept {
+    const std::uint8_t diff = static_cast<std::uint8_t>(on ^ off);
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+        const std::uint64_t word = words_[w];
+        const std::size_t base = w * kWordBits;
+        const std::size_t bits = std::min(kWordBits, size_ - base);
+        // Branch-free expansion of each bit into a byte
+        for (std::size_t b = 0; b < bits; ++b) {
+            const auto on_bit = static_cast<std::uint8_t>(0u - static_cast<unsigned>((word >> b) & 1u));
+            dst[base + b] = static_cast<std::uint8_t>(off ^ (diff & on_bit));
+        }
+    }
+}
+
+void KeyMask::requireSameSize(const KeyMask& other, const char* op) const {
+    if (other.size_ != size_) {
+        throw std::invalid_argument(std::string("KeyMask::") + op + " size mismatch");
+    }
+}
+
+void KeyMask::clearTail() noexcept {
+    const std::size_t tail = size_ % kWordBits;
+    if (tail != 0 && !words_.empty()) {
+        words_.back() &= (std::uint64_t{1} << tail) - 1;
+    }
+}
+
+}  // namespace kb::cfg
@@ -1,5 +1,8 @@
 #include "keyboard_configurator/keyboard_model.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <limits>
 #include <stdexcept>
 
@@ -9,6 +12,8 @@
 
 namespace kb::cfg {
 
+static_assert(sizeof(RgbColor) == 3, "encodeFrame copies RgbColor arrays as packed bytes");
+
 namespace {
 KeyboardModel::Layout flattenLayout(const KeyboardModel::Layout& layout,
                                     std::vector<std::string>& key_labels,
@@ -29,8 +34,35 @@ KeyboardModel::Layout flattenLayout(const KeyboardModel::Layout& layout,
     }
     return flattened;
 }
+
+// Source channel (0 = r, 1 = g, 2 = b) for each wire byte
+std::array<std::uint8_t, 3> channelMap(ChannelOrder order) {
+    switch (order) {
+    case ChannelOrder::RGB: return {0, 1, 2};
+    case ChannelOrder::RBG: return {0, 2, 1};
+    case ChannelOrder::GRB: return {1, 0, 2};
+    case ChannelOrder::GBR: return {1, 2, 0};
+    case ChannelOrder::BRG: return {2, 0, 1};
+    case ChannelOrder::BGR: return {2, 1, 0};
+    }
+    return {0, 1, 2};
+}
 }  // namespace
 
+std::optional<ChannelOrder> parseChannelOrder(const std::string& name) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) {
+        return static_cast<char>(std::toupper(c));
+    });
+    if (upper == "RGB") return ChannelOrder::RGB;
+    if (upper == "RBG") return ChannelOrder::RBG;
+    if (upper == "GRB") return ChannelOrder::GRB;
+    if (upper == "GBR") return ChannelOrder::GBR;
+    if (upper == "BRG") return ChannelOrder::BRG;
+    if (upper == "BGR") return ChannelOrder::BGR;
+    return std::nullopt;
+}
+
 KeyboardModel::KeyboardModel(std::string name,
                              std::uint16_t vendor_id,
                              std::uint16_t product_id,
@@ -47,6 +79,58 @@ KeyboardModel::KeyboardModel(std::string name,
       interface_usage_page_(interface_usage_page),
       interface_usage_(interface_usage) {
     layout_ = flattenLayout(layout, key_labels_, key_to_index_);
+    geometry_ = KeyGeometry::fromLayout(layout_);
+    compileEncodePlan();
+}
+
+void KeyboardModel::setKeyGeometry(std::vector<KeyRect> rects) {
+    if (rects.size() != key_labels_.size()) {
+        throw std::invalid_argument("Key geometry size does not match keyboard layout");
+    }
+    geometry_ = KeyGeometry(std::move(rects), key_labels_);
+}
+
+void KeyboardModel::compileEncodePlan() {
+    if (chunks_.empty()) {
+        chunks_.push_back(ReportChunk{packet_header_, 0, key_labels_.size()});
+    }
+
+    const auto order = encode_plan_.channel_order;
+    encode_plan_ = EncodePlan{};
+    encode_plan_.channel_order = order;
+    encode_plan_.channel_map = channelMap(order);
+    for (std::size_t c = 0; c < chunks_.size(); ++c) {
+        const auto& chunk = chunks_[c];
+        if (chunk.header.size() + chunk.key_count * 3 > packet_length_) {
+            encode_plan_.fits = false;
+        }
+        const std::size_t base = c * packet_length_ + chunk.header.size();
+        for (std::size_t k = 0; k < chunk.key_count; ++k) {
+            if (key_labels_[chunk.first_key + k] == "NAN") {
+                encode_plan_.blank_offsets.push_back(base + k * 3);
+            }
+        }
+    }
+}
+
+void KeyboardModel::setReportChunks(std::vector<ReportChunk> chunks) {
+    for (const auto& chunk : chunks) {
+        // Written so that huge values cannot wrap past the check
+        if (chunk.first_key > key_labels_.size() ||
+            chunk.key_count > key_labels_.size() - chunk.first_key) {
+            throw std::invalid_argument("Report chunk runs past the last key");
+        }
+        if (chunk.header.size() + chunk.key_count * 3 > packet_length_) {
+            throw std::invalid_argument("Report chunk exceeds packet length");
+        }
+    }
+    chunks_ = std::move(chunks);
+    compileEncodePlan();
+}
+
+void KeyboardModel::setChannelOrder(ChannelOrder order) {
+    encode_plan_.channel_order = order;
+    compileEncodePlan();
 }
 
 std::optional<std::size_t> KeyboardModel::indexForKey(const std::string& label) const {
@@ -86,32 +170,43 @@ void KeyboardModel::setKeycodeMap(const std::vector<int>& keycodes) {
 }
 
 std::vector<std::uint8_t> KeyboardModel::encodeFrame(const KeyColorFrame& frame) const {
+    std::vector<std::uint8_t> payload;
+    encodeFrame(frame, payload);
+    return payload;
+}
+
+void KeyboardModel::encodeFrame(const KeyColorFrame& frame, std::vector<std::uint8_t>& payload) const {
     if (frame.size() != key_labels_.size()) {
         throw std::runtime_error("Frame size does not match keyboard layout");
     }
+    if (!encode_plan_.fits) {
+        throw std::runtime_error("Payload exceeds packet length; split it with [[device.chunks]]");
+    }
 
-    std::vector<std::uint8_t> payload;
-    payload.reserve(packet_header_.size() + key_labels_.size() * 3);
-    payload.insert(payload.end(), packet_header_.begin(), packet_header_.end());
-
-    for (std::size_t idx = 0; idx < key_labels_.size(); ++idx) {
-        const auto& label = key_labels_[idx];
-        auto color = frame.color(idx);
-        if (label == "NAN") {
-            color = {0, 0, 0};
+    const auto& plan = encode_plan_;
+    payload.resize(payloadSize());
+    const auto* src = reinterpret_cast<const std::uint8_t*>(frame.data());
+    for (std::size_t c = 0; c < chunks_.size(); ++c) {
+        const auto& chunk = chunks_[c];
+        std::uint8_t* report = payload.data() + c * packet_length_;
+        std::uint8_t* colors = std::copy(chunk.header.begin(), chunk.header.end(), report);
+        const std::uint8_t* first = src + chunk.first_key * 3;
+        const std::size_t bytes = chunk.key_count * 3;
+        if (plan.channel_order == ChannelOrder::RGB) {
+            std::copy(first, first + bytes, colors);
+        } else {
+            const auto map = plan.channel_map;
+            for (std::size_t i = 0; i < bytes; i += 3) {
+                colors[i] = first[i + map[0]];
+                colors[i + 1] = first[i + map[1]];
+                colors[i + 2] = first[i + map[2]];
+            }
         }
-        payload.push_back(color.r);
-        payload.push_back(color.g);
-        payload.push_back(color.b);
+        std::fill(colors + bytes, report + packet_length_, std::uint8_t{0});
     }
-
-    if (payload.size() < packet_length_) {
-        payload.resize(packet_length_, 0);
-    } else if (payload.size() > packet_length_) {
-        throw std::runtime_error("Payload exceeds packet length");
+    for (std::size_t offset : plan.blank_offsets) {
+        std::fill_n(payload.data() + offset, 3, std::uint8_t{0});
     }
-
-    return payload;
 }
 
 }  // namespace kb::cfg
@@ -0,0 +1,109 @@
+#include "keyboard_configurator/layer_blend.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace kb::cfg {
+
+static_assert(sizeof(RgbColor) == 3, "blend kernels treat RgbColor arrays as packed bytes");
+
+namespace {
+
+// Exact round(x / 255) for x in [0, 255 * 255]
+inline unsigned div255(unsigned x) {
+    x += 128u;
+    return (x + (x >> 8)) >> 8;
+}
+
+// The kernels run over the packed byte view of the frame so the plain
+// per-byte loops auto-vectorise; coverage is expanded per key.
+template <typename Op>
+void blendBytes(std::uint8_t* dst,
+                const std::uint8_t* src,
+                const std::uint8_t* coverage,
+                std::size_t count,
+                Op op) {
+    if (coverage == nullptr) {
+        const std::size_t bytes = count * 3;
+        for (std::size_t i = 0; i < bytes; ++i) {
+            dst[i] = static_cast<std::uint8_t>(op(dst[i], src[i]));
+        }
+        return;
+    }
+    for (std::size_t k = 0; k < count; ++k) {
+        const unsigned a = coverage[k];
+        const unsigned inv = 255u - a;
+        for (std::size_t c = 0; c < 3; ++c) {
+            const std::size_t i = k * 3 + c;
+            const unsigned d = dst[i];
+            dst[i] = static_cast<std::uint8_t>(div255(d * inv + op(d, src[i]) * a));
+        }
+    }
+}
+
+}  // namespace
+
+std::optional<BlendMode> parseBlendMode(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (lower == "alpha" || lower == "normal") return BlendMode::Alpha;
+    if (lower == "add" || lower == "additive") return BlendMode::Add;
+    if (lower == "multiply") return BlendMode::Multiply;
+    if (lower == "screen") return BlendMode::Screen;
+    if (lower == "max" || lower == "lighten") return BlendMode::Max;
+    return std::nullopt;
+}
+
+void blendLayer(BlendMode mode,
+                RgbColor* dst,
+                const RgbColor* src,
+                const std::uint8_t* coverage,
+                std::size_t count) {
+    auto* d = reinterpret_cast<std::uint8_t*>(dst);
+    const auto* s = reinterpret_cast<const std::uint8_t*>(src);
+
+    switch (mode) {
+    case BlendMode::Alpha:
+        if (coverage == nullptr) {
+            std::memcpy(d, s, count * 3);
+            return;
+        }
+        blendBytes(d, s, coverage, count, [](unsigned, unsigned b) { return b; });
+        return;
+    case BlendMode::Add:
+        blendBytes(d, s, coverage, count, [](unsigned a, unsigned b) { return std::min(255u, a + b); });
+        return;
+    case BlendMode::Multiply:
+        blendBytes(d, s, coverage, count, [](unsigned a, unsigned b) { return div255(a * b); });
+        return;
+    case BlendMode::Screen:
+        blendBytes(d, s, coverage, count, [](unsigned a, unsigned b) {
+            return 255u - div255((255u - a) * (255u - b));
+        });
+        return;
+    case BlendMode::Max:
+        blendBytes(d, s, coverage, count, [](unsigned a, unsigned b) { return std::max(a, b); });
+        return;
+    }
+}
+
+void lerpFrames(RgbColor* dst,
+                const RgbColor* from,
+                const RgbColor* to,
+                std::uint8_t t,
+                std::size_t count) {
+    auto* d = reinterpret_cast<std::uint8_t*>(dst);
+    const auto* a = reinterpret_cast<const std::uint8_t*>(from);
+    const auto* b = reinterpret_cast<const std::uint8_t*>(to);
+    const unsigned wb = t;
+    const unsigned wa = 255u - wb;
+    const std::size_t bytes = count * 3;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        d[i] = static_cast<std::uint8_t>(div255(a[i] * wa + b[i] * wb));
+    }
+}
+
+}  // namespace kb::cfg
@@ -5,52 +5,9 @@
 #include <cctype>
 #include <string>
 
-namespace kb::cfg {
-
-namespace {
-RgbColor hsvToRgb(double h, double s, double v) {
-    double c = v * s;
-    double x = c * (1 - std::fabs(std::fmod(h / 60.0, 2) - 1));
-    double m = v - c;
-    double r = 0, g = 0, b = 0;
-    if (h < 60) { r = c; g = x; }
-    else if (h < 120) { r = x; g = c; }
-    else if (h < 180) { g = c; b = x; }
-    else if (h < 240) { g = x; b = c; }
-    else if (h < 300) { r = x; b = c; }
-    else { r = c; b = x; }
-    return {
-        static_cast<std::uint8_t>(std::clamp((r + m) * 255.0, 0.0, 255.0)),
-        static_cast<std::uint8_t>(std::clamp((g + m) * 255.0, 0.0, 255.0)),
-        static_cast<std::uint8_t>(std::clamp((b + m) * 255.0, 0.0, 255.0))
-    };
-}
-
-std::uint8_t mix8(std::uint8_t a, std::uint8_t b, double t) {
-    t = std::clamp(t, 0.0, 1.0);
-    return static_cast<std::uint8_t>(std::clamp<int>(static_cast<int>(std::lround(a + (b - a) * t)), 0, 255));
-}
+#include "keyboard_configurator/color.hpp"
 
-RgbColor parseHexColor(const std::string& value) {
-    if (value.size() != 7 || value.front() != '#') {
-        return {255, 255, 255};
-    }
-    auto hexToComponent = [](char hi, char lo) -> std::uint8_t {
-        auto hexValue = [](char ch) -> int {
-            if (ch >= '0' && ch <= '9') return ch - '0';
-            char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
-            if (upper >= 'A' && upper <= 'F') return 10 + (upper - 'A');
-            return 0;
-        };
-        return static_cast<std::uint8_t>((hexValue(hi) << 4) | hexValue(lo));
-    };
-    return {
-        hexToComponent(value[1], value[2]),
-        hexToComponent(value[3], value[4]),
-        hexToComponent(value[5], value[6])
-    };
-}
-}
+namespace kb::cfg {
 
 std::string LiquidPlasmaPreset::id() const { return "liquid_plasma"; }
 
@@ -127,44 +84,54 @@ void LiquidPlasmaPreset::configure(const ParameterMap& params) {
     if (auto it = params.find("reactive_splash"); it != params.end()) {
         reactive_splash_enabled_ = parseBool(it->second);
     }
+    buildLut();
 }
 
-void LiquidPlasmaPreset::buildCoords(const KeyboardModel& model) {
-    const auto& layout = model.layout();
-    std::size_t total = model.keyCount();
-    xs_.assign(total, 0.0);
-    ys_.assign(total, 0.0);
-    std::size_t idx = 0;
-    double rows = static_cast<double>(layout.size());
-    double max_cols = 1.0;
-    for (const auto& row : layout) max_cols = std::max<double>(max_cols, row.size());
-    for (std::size_t r = 0; r < layout.size(); ++r) {
-        const auto& row = layout[r];
-        for (std::size_t c = 0; c < row.size(); ++c) {
-            xs_[idx] = max_cols > 1.0 ? static_cast<double>(c) / (max_cols - 1.0) : 0.0;
-            ys_[idx] = rows > 1.0 ? static_cast<double>(r) / (rows - 1.0) : 0.0;
-            ++idx;
-        }
+void LiquidPlasmaPreset::buildLut() {
+    if (palette_.empty()) {
+        lut_ = GradientLut::hueWheel(saturation_, value_);
+    } else {
+        lut_ = GradientLut::fromStops(palette_, mix_mode_ == MixMode::Nearest);
     }
-    coords_built_ = true;
 }
 
 void LiquidPlasmaPreset::render(const KeyboardModel& model,
                                 double time_seconds,
                                 KeyColorFrame& frame) {
+    renderKeys(model, time_seconds, frame, nullptr);
+}
+
+void LiquidPlasmaPreset::renderVisible(const KeyboardModel& model,
+                                       double time_seconds,
+                                       KeyColorFrame& frame,
+                                       const std::vector<std::size_t>& visible) {
+    renderKeys(model, time_seconds, frame, &visible);
+}
+
+void LiquidPlasmaPreset::renderKeys(const KeyboardModel& model,
+                                    double time_seconds,
+                                    KeyColorFrame& frame,
+                                    const std::vector<std::size_t>* visible) {
     const auto total = model.keyCount();
     if (frame.size() != total) frame.resize(total);
-    if (!coords_built_) buildCoords(model);
+    const auto& geometry = model.geometry();
+    if (geometry.size() != total) return;
+    const auto& xs = geometry.xs();
+    const auto& ys = geometry.ys();
+    if (lut_.empty()) buildLut();
 
     const double t = time_seconds * speed_ * 2.0 * 3.14159265358979323846;
     std::vector<double> disp_x;
     std::vector<double> disp_y;
     std::vector<double> phase_shift;
-    const bool has_reactive_fields = computeReactiveFields(disp_x, disp_y, phase_shift);
-
-    for (std::size_t i = 0; i < total; ++i) {
-        double base_x = xs_[i];
-        double base_y = ys_[i];
+    const bool has_reactive_fields = computeReactiveFields(geometry, disp_x, disp_y, phase_shift);
+
+    auto out = frame.span(total);
+    const std::size_t count = visible ? visible->size() : total;
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        const std::size_t i = visible ? (*visible)[slot] : slot;
+        double base_x = xs[i];
+        double base_y = ys[i];
         if (has_reactive_fields && i < disp_x.size()) {
             base_x = std::clamp(base_x + disp_x[i], 0.0, 1.0);
         }
@@ -195,38 +162,20 @@ void LiquidPlasmaPreset::render(const KeyboardModel& model,
         double v01 = (v + static_cast<double>(terms)) / (2.0 * static_cast<double>(terms));
         v01 = std::clamp(v01, 0.0, 1.0);
 
-        RgbColor c{};
-        if (!palette_.empty()) {
-            if (palette_.size() == 1 || mix_mode_ == MixMode::Nearest) {
-                std::size_t idx = static_cast<std::size_t>(std::lround(v01 * (palette_.size() - 1)));
-                if (idx >= palette_.size()) idx = palette_.size() - 1;
-                c = palette_[idx];
-            } else {
-                double pos = v01 * (palette_.size() - 1);
-                std::size_t i0 = static_cast<std::size_t>(std::floor(pos));
-                std::size_t i1 = std::min(i0 + 1, palette_.size() - 1);
-                double f = pos - static_cast<double>(i0);
-                const RgbColor& a = palette_[i0];
-                const RgbColor& b = palette_[i1];
-                c.r = mix8(a.r, b.r, f);
-                c.g = mix8(a.g, b.g, f);
-                c.b = mix8(a.b, b.b, f);
-            }
-        } else {
-            double hue = 360.0 * v01;
-            c = hsvToRgb(hue, std::clamp(saturation_, 0.0, 1.0), std::clamp(value_, 0.0, 1.0));
-        }
-        frame.setColor(i, c);
+        out[i] = lut_.at(v01);
     }
 
 }
 
-bool LiquidPlasmaPreset::computeReactiveFields(std::vector<double>& disp_x,
+bool LiquidPlasmaPreset::computeReactiveFields(const KeyGeometry& geometry,
+                                               std::vector<double>& disp_x,
                                                std::vector<double>& disp_y,
                                                std::vector<double>& phase_shift) {
-    if (!reactive_enabled_ || !provider_ || !coords_built_) return false;
+    if (!reactive_enabled_ || !provider_) return false;
 
-    const auto total = xs_.size();
+    const auto& xs = geometry.xs();
+    const auto& ys = geometry.ys();
+    const auto total = xs.size();
     if (total == 0) return false;
 
     // Reset outputs
@@ -247,6 +196,9 @@ bool LiquidPlasmaPreset::computeReactiveFields(std::vector<double>& disp_x,
     // We assume any contribution < 0.5% is invisible.
     // This dramatically reduces CPU load.
     const double cutoff_dist2 = 6.0 * sigma2; 
+    // Turbulence moves keys by up to 0.02 * turbulence on both axes, so
+    // widen the spatial query by that much to keep the cutoff exact.
+    const double query_radius = std::sqrt(cutoff_dist2) + 0.02 * reactive_turbulence_ * std::sqrt(2.0);
 
     const double base_disp = std::max(0.0, reactive_displacement_);
     const double phase_scale = std::max(0.0, reactive_phase_shift_);
@@ -288,11 +240,12 @@ bool LiquidPlasmaPreset::computeReactiveFields(std::vector<double>& disp_x,
              drift_y = age * speed_ * 0.5;
         }
 
-        const double ex = xs_[ev.key_index] + drift_x;
-        const double ey = ys_[ev.key_index] + drift_y;
+        const double ex = xs[ev.key_index] + drift_x;
+        const double ey = ys[ev.key_index] + drift_y;
 
-        // INNER LOOP: Iterate keys
-        for (std::size_t k = 0; k < total; ++k) {
+        // INNER LOOP: Iterate keys near the epicentre
+        geometry.index().queryRadius(ex, ey, query_radius, nearby_);
+        for (const std::size_t k : nearby_) {
             
             // UPGRADE 2: Turbulence (Warp)
             // Adds pseudo-random offsets to key positions.
@@ -303,8 +256,8 @@ bool LiquidPlasmaPreset::computeReactiveFields(std::vector<double>& disp_x,
                 warp = std::sin(static_cast<double>(k) * 132.5) * 0.02 * reactive_turbulence_;
             }
 
-            const double dx = (xs_[k] + warp) - ex;
-            const double dy = (ys_[k] + warp) - ey;
+            const double dx = (xs[k] + warp) - ex;
+            const double dy = (ys[k] + warp) - ey;
             const double dist2 = dx * dx + dy * dy;
 
             // OPTIMIZATION: Distance Cutoff
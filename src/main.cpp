@@ -1,7 +1,9 @@
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 #include "keyboard_configurator/config_loader.hpp"
 #include "keyboard_configurator/configurator_cli.hpp"
@@ -40,6 +42,7 @@ using kb::cfg::ReactionDiffusionPreset;
 using kb::cfg::ReactiveRipplePreset;
 using kb::cfg::RetryHelper;
 using kb::cfg::RuntimeConfig;
+using kb::cfg::SharedFrameRing;
 using kb::cfg::ShortcutWatcher;
 using kb::cfg::SmokePreset;
 using kb::cfg::SpaceColonizationPreset;
@@ -66,6 +69,85 @@ PresetRegistry buildRegistry()
     return registry;
 }
 
+// One keyboard's pipeline. Heap-allocated so the references the engine and
+// CLI hold into it stay valid; members are destroyed CLI first.
+struct DeviceSession {
+    explicit DeviceSession(RuntimeConfig loaded) : runtime(std::move(loaded)) {}
+
+    RuntimeConfig runtime;
+    std::unique_ptr<DeviceTransport> transport;
+    std::shared_ptr<KeyActivityProvider> key_activity;
+    std::unique_ptr<EffectEngine> engine;
+    std::unique_ptr<ConfiguratorCLI> cli;
+};
+
+std::unique_ptr<DeviceSession> openDevice(RuntimeConfig loaded)
+{
+    auto session = std::make_unique<DeviceSession>(std::move(loaded));
+    auto& runtime = session->runtime;
+    session->transport = std::move(runtime.transport);
+    auto& transport = session->transport;
+
+    // Use exponential backoff retry when connecting to device. With
+    // `reconnect` on (the default) connect never fails and the device
+    // is awaited in the background instead.
+    RetryHelper retry_helper;
+    bool connected = retry_helper.executeWithRetry(
+        [&transport, &runtime]() {
+            return transport->connect(runtime.model);
+        },
+        "Device connection"
+    );
+
+    if (!connected) {
+        throw std::runtime_error("Failed to connect to " + runtime.model.name() + " after retries");
+    }
+
+    session->key_activity = std::make_shared<KeyActivityProvider>(runtime.model.keyCount());
+
+    session->engine = std::make_unique<EffectEngine>(runtime.model, *transport);
+    auto& engine = *session->engine;
+    engine.setKeyActivityProvider(session->key_activity);
+    engine.setKeepAliveInterval(runtime.keepalive_interval);
+    engine.setRenderThreads(runtime.render_threads);
+    engine.setOutputSettings(runtime.output);
+    if (!runtime.preview_ring.empty()) {
+        // The preview is optional; never let it keep the keyboard dark
+        try {
+            engine.setFrameRing(std::make_shared<SharedFrameRing>(
+                runtime.preview_ring, runtime.model, runtime.preview_slots));
+        } catch (const std::exception& ex) {
+            std::cerr << "Warning: preview ring disabled: " << ex.what() << '\n';
+        }
+    }
+    // One write thread per device: the async transport's writer when
+    // configured, the engine's own stage otherwise
+    if (!runtime.async_writes) {
+        engine.startTransportStage();
+    }
+    engine.setPresets(std::move(runtime.presets), std::move(runtime.preset_masks));
+    // Apply enabled flags from config
+    for (std::size_t i = 0; i < runtime.preset_enabled.size(); ++i) {
+        engine.setPresetEnabled(i, runtime.preset_enabled[i]);
+    }
+    for (std::size_t i = 0; i < runtime.preset_blend.size(); ++i) {
+        engine.setPresetBlend(i, runtime.preset_blend[i]);
+        engine.setPresetAlpha(i, std::move(runtime.preset_alpha[i]));
+        engine.setPresetUpdateRate(i, runtime.preset_update_hz[i]);
+    }
+
+    session->cli = std::make_unique<ConfiguratorCLI>(runtime.model,
+        engine,
+        std::move(runtime.preset_parameters),
+        runtime.frame_interval);
+    session->cli->setOverrunPolicy(runtime.overrun_policy);
+    if (runtime.model.hasKeycodeMap()) {
+        // Key presses only reach the provider through the keycode map
+        session->cli->setIdlePolicy(runtime.idle, session->key_activity);
+    }
+    return session;
+}
+
 } // namespace
 
 int main(int argc, char** argv)
@@ -81,65 +163,76 @@ int main(int argc, char** argv)
 
         // Reload loop - when config changes, we restart
         while (true) {
-            RuntimeConfig runtime = loader.loadFromFile(config_path);
-
-            auto transport = std::move(runtime.transport);
-            
-            // Use exponential backoff retry when connecting to device
-            RetryHelper retry_helper;
-            bool connected = retry_helper.executeWithRetry(
-                [&transport, &runtime]() {
-                    return transport->connect(runtime.model);
-                },
-                "Device connection"
-            );
-
-            if (!connected) {
-                throw std::runtime_error("Failed to connect to device after retries");
+            std::vector<std::unique_ptr<DeviceSession>> sessions;
+            for (auto& runtime : loader.loadDevicesFromFile(config_path)) {
+                sessions.push_back(openDevice(std::move(runtime)));
             }
+            // The first keyboard owns the prompt; the others follow the same
+            // watchers and render on their own loops
+            auto& primary = *sessions.front();
+            primary.cli->setConfigPath(config_path);
 
-            auto key_activity = std::make_shared<KeyActivityProvider>(runtime.model.keyCount());
-
-            EffectEngine engine(runtime.model, *transport);
-            engine.setKeyActivityProvider(key_activity);
-            engine.setPresets(std::move(runtime.presets), std::move(runtime.preset_masks));
-            // Apply enabled flags from config
-            for (std::size_t i = 0; i < runtime.preset_enabled.size(); ++i) {
-                engine.setPresetEnabled(i, runtime.preset_enabled[i]);
-            }
-
-            ConfiguratorCLI cli(runtime.model,
-                engine,
-                std::move(runtime.preset_parameters),
-                runtime.frame_interval);
-
-            // Set config path for optional watching
-            cli.setConfigPath(config_path);
-
+            // One set of input and focus watchers feeds every keyboard
             std::unique_ptr<KeyActivityWatcher> key_watcher;
-            if (runtime.model.hasKeycodeMap()) {
-                key_watcher = std::make_unique<KeyActivityWatcher>(runtime.model, key_activity);
+            for (auto& session : sessions) {
+                auto& runtime = session->runtime;
+                if (!runtime.model.hasKeycodeMap()) continue;
+                if (!key_watcher) {
+                    key_watcher = std::make_unique<KeyActivityWatcher>(runtime.model, session->key_activity);
+                } else {
+                    key_watcher->addTarget(runtime.model, session->key_activity);
+                }
+            }
+            if (key_watcher) {
                 key_watcher->start();
             }
 
             std::unique_ptr<ShortcutWatcher> shortcuts;
             std::unique_ptr<HyprlandWatcher> hypr;
-            if (runtime.hypr && runtime.hypr->enabled) {
-                // Start shortcut watcher first so hypr callback can safely reference it
-                if (runtime.hypr->shortcuts_overlay_preset_index >= 0) {
-                    shortcuts = std::make_unique<ShortcutWatcher>(runtime.model, cli, *runtime.hypr, runtime.model.keyCount());
-                    shortcuts->start();
+            // Start shortcut watcher first so hypr callbacks can safely reference it
+            std::vector<std::size_t> shortcut_target(sessions.size(), sessions.size());
+            std::size_t shortcut_targets = 0;
+            for (std::size_t i = 0; i < sessions.size(); ++i) {
+                auto& runtime = sessions[i]->runtime;
+                if (!runtime.hypr || !runtime.hypr->enabled ||
+                    runtime.hypr->shortcuts_overlay_preset_index < 0) {
+                    continue;
                 }
-                hypr = std::make_unique<HyprlandWatcher>(*runtime.hypr, cli, engine.presetCount());
-                if (shortcuts) {
-                    hypr->setActiveClassCallback([sw = shortcuts.get()](const std::string& klass) {
-                        return sw->setActiveClass(klass);
-                    });
+                if (!shortcuts) {
+                    shortcuts = std::make_unique<ShortcutWatcher>(runtime.model, *sessions[i]->cli, *runtime.hypr, runtime.model.keyCount());
+                } else {
+                    shortcuts->addTarget(runtime.model, *sessions[i]->cli, *runtime.hypr, runtime.model.keyCount());
                 }
+                shortcut_target[i] = shortcut_targets++;
+            }
+            if (shortcuts) {
+                shortcuts->start();
+            }
+
+            for (std::size_t i = 0; i < sessions.size(); ++i) {
+                auto& session = *sessions[i];
+                if (!session.runtime.hypr || !session.runtime.hypr->enabled) continue;
+                HyprlandWatcher::ClassCallback on_class;
+                if (shortcut_target[i] < shortcut_targets) {
+                    on_class = [sw = shortcuts.get(), t = shortcut_target[i]](const std::string& klass) {
+                        return sw->setActiveClass(klass, t);
+                    };
+                }
+                if (!hypr) {
+                    hypr = std::make_unique<HyprlandWatcher>(*session.runtime.hypr, *session.cli, session.engine->presetCount());
+                    hypr->setActiveClassCallback(std::move(on_class));
+                } else {
+                    hypr->addTarget(*session.runtime.hypr, *session.cli, session.engine->presetCount(), std::move(on_class));
+                }
+            }
+            if (hypr) {
                 hypr->start();
             }
 
-            cli.run();
+            for (std::size_t i = 1; i < sessions.size(); ++i) {
+                sessions[i]->cli->startRendering();
+            }
+            primary.cli->run();
 
             // Cleanup
             if (key_watcher) {
@@ -153,7 +246,7 @@ int main(int argc, char** argv)
             }
 
             // If config changed (user enabled watch and it detected a change), reload
-            if (cli.isConfigChanged()) {
+            if (primary.cli->isConfigChanged()) {
                 std::cout << "[Main] Reloading configuration...\n";
             } else {
                 break;
@@ -0,0 +1,190 @@
+#include "keyboard_configurator/output_stage.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "keyboard_configurator/keyboard_model.hpp"
+
+namespace kb::cfg {
+
+namespace {
+
+// Authored 8-bit values are treated as gamma 2.2 encoded
+constexpr double kWorkingGamma = 2.2;
+
+const std::array<float, 256>& decodeTable() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> t{};
+        for (std::size_t i = 0; i < t.size(); ++i) {
+            t[i] = static_cast<float>(std::pow(static_cast<double>(i) / 255.0, kWorkingGamma));
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Clamps to [0, 1]; NaN maps to 0
+inline float unit(float x) {
+    return x > 0.0f ? (x < 1.0f ? x : 1.0f) : 0.0f;
+}
+
+template <typename Op>
+void blendPlanes(float* dst,
+                 const RgbColor* src,
+                 std::size_t channel,
+                 const std::uint8_t* coverage,
+                 std::size_t count,
+                 Op op) {
+    const auto& decode = decodeTable();
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(src) + channel;
+    if (coverage == nullptr) {
+        for (std::size_t k = 0; k < count; ++k) {
+            dst[k] = op(dst[k], decode[bytes[k * 3]]);
+        }
+        return;
+    }
+    constexpr float kInv255 = 1.0f / 255.0f;
+    for (std::size_t k = 0; k < count; ++k) {
+        const float a = static_cast<float>(coverage[k]) * kInv255;
+        const float d = dst[k];
+        dst[k] = d + (op(d, decode[bytes[k * 3]]) - d) * a;
+    }
+}
+
+template <typename Op>
+void blendFrame(LinearFrame& dst,
+                const RgbColor* src,
+                const std::uint8_t* coverage,
+                std::size_t count,
+                Op op) {
+    blendPlanes(dst.r(), src, 0, coverage, count, op);
+    blendPlanes(dst.g(), src, 1, coverage, count, op);
+    blendPlanes(dst.b(), src, 2, coverage, count, op);
+}
+
+}  // namespace
+
+static_assert(sizeof(RgbColor) == 3, "linear kernels treat RgbColor arrays as packed bytes");
+
+void LinearFrame::resize(std::size_t key_count) {
+    r_.assign(key_count, 0.0f);
+    g_.assign(key_count, 0.0f);
+    b_.assign(key_count, 0.0f);
+}
+
+void LinearFrame::clear() {
+    std::fill(r_.begin(), r_.end(), 0.0f);
+    std::fill(g_.begin(), g_.end(), 0.0f);
+    std::fill(b_.begin(), b_.end(), 0.0f);
+}
+
+void LinearFrame::decode(const RgbColor* src, std::size_t count) {
+    clear();
+    blendFrame(*this, src, nullptr, std::min(count, size()), [](float, float s) { return s; });
+}
+
+void blendLayerLinear(BlendMode mode,
+                      LinearFrame& dst,
+                      const RgbColor* src,
+                      const std::uint8_t* coverage,
+                      std::size_t count) {
+    count = std::min(count, dst.size());
+    switch (mode) {
+    case BlendMode::Alpha:
+        blendFrame(dst, src, coverage, count, [](float, float s) { return s; });
+        return;
+    case BlendMode::Add:
+        blendFrame(dst, src, coverage, count, [](float d, float s) { return d + s; });
+        return;
+    case BlendMode::Multiply:
+        blendFrame(dst, src, coverage, count, [](float d, float s) { return d * s; });
+        return;
+    case BlendMode::Screen:
+        blendFrame(dst, src, coverage, count, [](float d, float s) { return d + s - d * s; });
+        return;
+    case BlendMode::Max:
+        blendFrame(dst, src, coverage, count, [](float d, float s) { return std::max(d, s); });
+        return;
+    }
+}
+
+OutputStage::OutputStage() {
+    configure(OutputSettings{});
+}
+
+void OutputStage::configure(const OutputSettings& settings) {
+    settings_ = settings;
+    settings_.brightness = std::clamp(settings_.brightness, 0.0, 1.0);
+    if (!(settings_.gamma > 0.0)) {
+        settings_.gamma = 1.0;
+    }
+
+    const auto brightness = static_cast<float>(settings_.brightness);
+    bool identity_matrix = brightness == 1.0f;
+    for (std::size_t i = 0; i < matrix_.size(); ++i) {
+        matrix_[i] = settings_.white_balance[i] * brightness;
+        const float expected = (i % 4 == 0) ? 1.0f : 0.0f;
+        identity_matrix = identity_matrix && settings_.white_balance[i] == expected;
+    }
+
+    // out = in^gamma = linear^(gamma / 2.2) = s^(2 * gamma / 2.2) with s = sqrt(linear)
+    const double exponent = 2.0 * settings_.gamma / kWorkingGamma;
+    lut_.resize(kLutSize);
+    for (std::size_t i = 0; i < kLutSize; ++i) {
+        const double s = static_cast<double>(i) / static_cast<double>(kLutSize - 1);
+        lut_[i] = static_cast<std::uint16_t>(std::lround(std::pow(s, exponent) * 255.0 * 256.0));
+    }
+
+    identity_ = identity_matrix && settings_.gamma == 1.0 && !settings_.dither && !settings_.linear_blend;
+}
+
+void OutputStage::setLayout(const KeyboardModel& model) {
+    const auto& labels = model.keyLabels();
+    keep_.resize(labels.size());
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+        keep_[i] = labels[i] == "NAN" ? 0x00 : 0xFF;
+    }
+}
+
+void OutputStage::process(const LinearFrame& frame, RgbColor* out) {
+    const std::size_t count = frame.size();
+    if (keep_.size() != count) {
+        keep_.assign(count, 0xFF);
+    }
+    index_.resize(count * 3);
+
+    // Colour math and LUT indices, plane by plane so the loop vectorises
+    const float* r = frame.r();
+    const float* g = frame.g();
+    const float* b = frame.b();
+    std::uint16_t* ir = index_.data();
+    std::uint16_t* ig = ir + count;
+    std::uint16_t* ib = ig + count;
+    const auto m = matrix_;
+    constexpr float kScale = static_cast<float>(kLutSize - 1);
+    for (std::size_t k = 0; k < count; ++k) {
+        const float cr = unit(m[0] * r[k] + m[1] * g[k] + m[2] * b[k]);
+        const float cg = unit(m[3] * r[k] + m[4] * g[k] + m[5] * b[k]);
+        const float cb = unit(m[6] * r[k] + m[7] * g[k] + m[8] * b[k]);
+        ir[k] = static_cast<std::uint16_t>(std::sqrt(cr) * kScale + 0.5f);
+        ig[k] = static_cast<std::uint16_t>(std::sqrt(cg) * kScale + 0.5f);
+        ib[k] = static_cast<std::uint16_t>(std::sqrt(cb) * kScale + 0.5f);
+    }
+
+    // Table lookup, rounding or dithering the 8.8 level, then blanking.
+    // The dither offset walks through all 256 thresholds over 256 frames
+    // (odd stride) from a per-key start, so the time average is exact.
+    const std::uint32_t frame_offset = settings_.dither ? frame_counter_++ * 97u : 0u;
+    const std::uint16_t* lut = lut_.data();
+    for (std::size_t k = 0; k < count; ++k) {
+        const std::uint32_t threshold = settings_.dither
+            ? ((static_cast<std::uint32_t>(k) * 2654435761u >> 24) + frame_offset) & 0xFFu
+            : 0x80u;
+        const std::uint8_t keep = keep_[k];
+        out[k].r = static_cast<std::uint8_t>(((lut[ir[k]] + threshold) >> 8) & keep);
+        out[k].g = static_cast<std::uint8_t>(((lut[ig[k]] + threshold) >> 8) & keep);
+        out[k].b = static_cast<std::uint8_t>(((lut[ib[k]] + threshold) >> 8) & keep);
+    }
+}
+
+}  // namespace kb::cfg
@@ -4,29 +4,11 @@
 #include <cmath>
 #include <cctype>
 
+#include "keyboard_configurator/color.hpp"
+
 namespace kb::cfg {
 
 namespace {
-RgbColor parseHexColor(const std::string& value) {
-    if (value.size() != 7 || value.front() != '#') {
-        return {255, 255, 255};
-    }
-    auto hexToComponent = [](char hi, char lo) -> std::uint8_t {
-        auto hexValue = [](char ch) -> int {
-            if (ch >= '0' && ch <= '9') return ch - '0';
-            char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
-            if (upper >= 'A' && upper <= 'F') return 10 + (upper - 'A');
-            return 0;
-        };
-        return static_cast<std::uint8_t>((hexValue(hi) << 4) | hexValue(lo));
-    };
-    return {
-        hexToComponent(value[1], value[2]),
-        hexToComponent(value[3], value[4]),
-        hexToComponent(value[5], value[6])
-    };
-}
-
 inline std::uint32_t hash32(std::uint32_t x) {
     x ^= x >> 16; x *= 0x7feb352dU; x ^= x >> 15; x *= 0x846ca68bU; x ^= x >> 16; return x;
 }
@@ -46,6 +28,7 @@ void ReactionDiffusionPreset::configure(const ParameterMap& params) {
     if (auto it = params.find("speed"); it != params.end()) speed_ = std::stod(it->second);
     if (auto it = params.find("color_a"); it != params.end()) color_a_ = parseHexColor(it->second);
     if (auto it = params.find("color_b"); it != params.end()) color_b_ = parseHexColor(it->second);
+    lut_ = GradientLut::fromStops({color_a_, color_b_});
 
     auto parseBool = [](std::string value) {
         std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
@@ -112,42 +95,43 @@ void ReactionDiffusionPreset::step(double dt) {
     v_.swap(v2);
 }
 
-void ReactionDiffusionPreset::buildCoords(const KeyboardModel& model) {
-    const auto& layout = model.layout();
-    std::size_t total = model.keyCount();
-    xs_.assign(total, 0.0);
-    ys_.assign(total, 0.0);
-    std::size_t idx = 0;
-    double rows = static_cast<double>(layout.size());
-    double max_cols = 1.0;
-    for (const auto& row : layout) max_cols = std::max<double>(max_cols, row.size());
-    for (std::size_t r = 0; r < layout.size(); ++r) {
-        const auto& row = layout[r];
-        for (std::size_t c = 0; c < row.size(); ++c) {
-            xs_[idx] = max_cols > 1.0 ? static_cast<double>(c) / (max_cols - 1.0) : 0.0;
-            ys_[idx] = rows > 1.0 ? static_cast<double>(r) / (rows - 1.0) : 0.0;
-            ++idx;
-        }
-    }
-    coords_built_ = true;
-}
-
 void ReactionDiffusionPreset::render(const KeyboardModel& model,
                                      double time_seconds,
                                      KeyColorFrame& frame) {
+    renderKeys(model, time_seconds, frame, nullptr);
+}
+
+void ReactionDiffusionPreset::renderVisible(const KeyboardModel& model,
+                                            double time_seconds,
+                                            KeyColorFrame& frame,
+                                            const std::vector<std::size_t>& visible) {
+    renderKeys(model, time_seconds, frame, &visible);
+}
+
+void ReactionDiffusionPreset::renderKeys(const KeyboardModel& model,
+                                         double time_seconds,
+                                         KeyColorFrame& frame,
+                                         const std::vector<std::size_t>* visible) {
     const auto total = model.keyCount();
     if (frame.size() != total) frame.resize(total);
     if (!inited_) initGrid();
-    if (!coords_built_) buildCoords(model);
+    const auto& geometry = model.geometry();
+    if (geometry.size() != total) return;
+    const auto& xs = geometry.xs();
+    const auto& ys = geometry.ys();
+    if (lut_.empty()) lut_ = GradientLut::fromStops({color_a_, color_b_});
 
-    applyKeyActivityInjection();
+    applyKeyActivityInjection(geometry);
 
     double dt = 0.5 * speed_;
     for (int s = 0; s < steps_per_frame_; ++s) step(dt);
 
-    for (std::size_t i = 0; i < total; ++i) {
-        double x = xs_[i];
-        double y = ys_[i];
+    auto out = frame.span(total);
+    const std::size_t count = visible ? visible->size() : total;
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        const std::size_t i = visible ? (*visible)[slot] : slot;
+        double x = xs[i];
+        double y = ys[i];
         double gx = (x * zoom_) * (width_ - 1);
         double gy = (y * zoom_) * (height_ - 1);
         int x0 = static_cast<int>(std::floor(gx));
@@ -163,19 +147,17 @@ void ReactionDiffusionPreset::render(const KeyboardModel& model,
         double vx1 = v01 * (1.0 - tx) + v11 * tx;
         double vxy = vx0 * (1.0 - ty) + vx1 * ty;
         double t = std::clamp(vxy, 0.0, 1.0);
-        RgbColor c{};
-        c.r = static_cast<std::uint8_t>(std::clamp<int>(static_cast<int>(std::lround(color_a_.r * (1.0 - t) + color_b_.r * t)), 0, 255));
-        c.g = static_cast<std::uint8_t>(std::clamp<int>(static_cast<int>(std::lround(color_a_.g * (1.0 - t) + color_b_.g * t)), 0, 255));
-        c.b = static_cast<std::uint8_t>(std::clamp<int>(static_cast<int>(std::lround(color_a_.b * (1.0 - t) + color_b_.b * t)), 0, 255));
-        frame.setColor(i, c);
+        out[i] = lut_.at(t);
     }
 }
 
-void ReactionDiffusionPreset::applyKeyActivityInjection() {
-    if (!reactive_enabled_ || !key_activity_provider_ || !coords_built_) {
+void ReactionDiffusionPreset::applyKeyActivityInjection(const KeyGeometry& geometry) {
+    if (!reactive_enabled_ || !key_activity_provider_) {
         return;
     }
-    const auto total_keys = xs_.size();
+    const auto& xs = geometry.xs();
+    const auto& ys = geometry.ys();
+    const auto total_keys = xs.size();
     if (total_keys == 0 || width_ <= 0 || height_ <= 0) {
         return;
     }
@@ -206,8 +188,8 @@ void ReactionDiffusionPreset::applyKeyActivityInjection() {
         if (weight <= 0.0) {
             continue;
         }
-        double gx = xs_[ev.key_index] * (width_ - 1);
-        double gy = ys_[ev.key_index] * (height_ - 1);
+        double gx = xs[ev.key_index] * (width_ - 1);
+        double gy = ys[ev.key_index] * (height_ - 1);
         int cx = static_cast<int>(std::round(gx));
         int cy = static_cast<int>(std::round(gy));
 
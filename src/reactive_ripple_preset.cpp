@@ -4,6 +4,8 @@
 #include <cctype>
 #include <cmath>
 
+#include "keyboard_configurator/color.hpp"
+
 namespace kb::cfg {
 namespace {
 std::string trim(const std::string& input) {
@@ -72,23 +74,35 @@ void ReactiveRipplePreset::setKeyActivityProvider(KeyActivityProviderPtr provide
 void ReactiveRipplePreset::render(const KeyboardModel& model,
                                   double /*time_seconds*/,
                                   KeyColorFrame& frame) {
+    renderKeys(model, frame, nullptr);
+}
+
+void ReactiveRipplePreset::renderVisible(const KeyboardModel& model,
+                                         double /*time_seconds*/,
+                                         KeyColorFrame& frame,
+                                         const std::vector<std::size_t>& visible) {
+    renderKeys(model, frame, &visible);
+}
+
+void ReactiveRipplePreset::renderKeys(const KeyboardModel& model,
+                                      KeyColorFrame& frame,
+                                      const std::vector<std::size_t>* visible) {
     const auto total = model.keyCount();
     if (frame.size() != total) {
         frame.resize(total);
     }
-    if (!coords_built_) {
-        buildCoords(model);
-    }
-
     frame.fill(base_color_);
+    auto out = frame.span(total);
 
     if (!provider_) {
         return;
     }
 
-    if (xs_.size() != total || ys_.size() != total) {
-        coords_built_ = false;
-        buildCoords(model);
+    const auto& geometry = model.geometry();
+    const auto& xs = geometry.xs();
+    const auto& ys = geometry.ys();
+    if (xs.size() != total) {
+        return;
     }
 
     const double thickness = std::max(0.005, thickness_);
@@ -100,23 +114,26 @@ void ReactiveRipplePreset::render(const KeyboardModel& model,
         return;
     }
 
-    std::vector<double> contributions(total, 0.0);
+    contributions_.assign(total, 0.0);
+    const std::size_t count = visible ? visible->size() : total;
     const double now = provider_->nowSeconds();
     for (const auto& ev : events) {
-        if (ev.key_index >= xs_.size()) {
+        if (ev.key_index >= total) {
             continue;
         }
-        const double ex = xs_[ev.key_index];
-        const double ey = ys_[ev.key_index];
+        const double ex = xs[ev.key_index];
+        const double ey = ys[ev.key_index];
         const double age = std::max(0.0, now - ev.time_seconds);
         const double radius = speed * age;
         if (radius <= 0.0) {
             continue;
         }
         const double decay_factor = std::exp(-age / decay);
-        for (std::size_t k = 0; k < total; ++k) {
-            const double dx = xs_[k] - ex;
-            const double dy = ys_[k] - ey;
+        // Only keys inside the outer edge of the ring can be lit
+        geometry.index().queryRadius(ex, ey, radius + thickness, nearby_);
+        for (const std::size_t k : nearby_) {
+            const double dx = xs[k] - ex;
+            const double dy = ys[k] - ey;
             const double dist = std::sqrt(dx * dx + dy * dy);
             const double diff = std::abs(dist - radius);
             if (diff > thickness) {
@@ -125,16 +142,17 @@ void ReactiveRipplePreset::render(const KeyboardModel& model,
             double amount = 1.0 - (diff / thickness);
             amount *= decay_factor;
             amount *= ev.intensity * intensity_scale_;
-            contributions[k] += amount;
+            contributions_[k] += amount;
         }
     }
 
-    for (std::size_t k = 0; k < total; ++k) {
-        const double add = contributions[k];
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        const std::size_t k = visible ? (*visible)[slot] : slot;
+        const double add = contributions_[k];
         if (add <= 0.0) {
             continue;
         }
-        auto color = frame.color(k);
+        auto& color = out[k];
         auto accumulate = [&](std::uint8_t base_channel, std::uint8_t ripple_channel) {
             const double value = static_cast<double>(base_channel) + static_cast<double>(ripple_channel) * add;
             return static_cast<std::uint8_t>(std::clamp<int>(static_cast<int>(std::lround(value)), 0, 255));
@@ -142,49 +160,7 @@ void ReactiveRipplePreset::render(const KeyboardModel& model,
         color.r = accumulate(color.r, ripple_color_.r);
         color.g = accumulate(color.g, ripple_color_.g);
         color.b = accumulate(color.b, ripple_color_.b);
-        frame.setColor(k, color);
     }
 }
 
-void ReactiveRipplePreset::buildCoords(const KeyboardModel& model) {
-    const auto& layout = model.layout();
-    const double rows = static_cast<double>(layout.size());
-    double max_cols = 1.0;
-    for (const auto& row : layout) {
-        max_cols = std::max<double>(max_cols, row.size());
-    }
-    xs_.assign(model.keyCount(), 0.0);
-    ys_.assign(model.keyCount(), 0.0);
-
-    std::size_t idx = 0;
-    for (std::size_t r = 0; r < layout.size(); ++r) {
-        const auto& row = layout[r];
-        for (std::size_t c = 0; c < row.size(); ++c) {
-            if (idx >= xs_.size()) {
-                break;
-            }
-            xs_[idx] = max_cols > 1.0 ? static_cast<double>(c) / (max_cols - 1.0) : 0.0;
-            ys_[idx] = rows > 1.0 ? static_cast<double>(r) / (rows - 1.0) : 0.0;
-            ++idx;
-        }
-    }
-    coords_built_ = true;
-}
-
-RgbColor ReactiveRipplePreset::parseHexColor(const std::string& value) {
-    if (value.size() != 7 || value.front() != '#') {
-        return {255, 255, 255};
-    }
-    auto hexValue = [](char ch) -> int {
-        if (ch >= '0' && ch <= '9') return ch - '0';
-        char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
-        if (upper >= 'A' && upper <= 'F') return 10 + (upper - 'A');
-        return 0;
-    };
-    auto hexComponent = [&](std::size_t idx) -> std::uint8_t {
-        return static_cast<std::uint8_t>((hexValue(value[idx]) << 4) | hexValue(value[idx + 1]));
-    };
-    return {hexComponent(1), hexComponent(3), hexComponent(5)};
-}
-
 }  // namespace kb::cfg
@@ -0,0 +1,163 @@
+#include "keyboard_configurator/reconnecting_transport.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include "keyboard_configurator/keyboard_model.hpp"
+
+namespace kb::cfg {
+
+ReconnectingTransport::ReconnectingTransport(std::unique_ptr<DeviceTransport> inner, Backoff backoff)
+    : inner_(std::move(inner)), backoff_(backoff) {
+    backoff_.initial = std::max(backoff_.initial, std::chrono::milliseconds(1));
+    backoff_.max = std::max(backoff_.max, backoff_.initial);
+    backoff_.multiplier = std::max(backoff_.multiplier, 1.0);
+    thread_ = std::thread([this] { reconnectLoop(); });
+}
+
+ReconnectingTransport::~ReconnectingTransport() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+std::string ReconnectingTransport::id() const {
+    return inner_->id();
+}
+
+bool ReconnectingTransport::connect(const KeyboardModel& model) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!model_) {
+        model_ = std::make_unique<KeyboardModel>(model);
+    }
+    // Under the lock so the reconnect thread cannot race the first attempt
+    connected_ = inner_->connect(model);
+    const bool ok = connected_;
+    lock.unlock();
+    if (!ok) {
+        std::cerr << "[ReconnectingTransport] " << inner_->id()
+                  << " device not available, waiting for it in the background" << '\n';
+        cv_.notify_all();
+    }
+    return true;
+}
+
+bool ReconnectingTransport::sendFrame(const KeyboardModel& model,
+                                      const std::vector<std::uint8_t>& payload) {
+    return send(model, payload, nullptr);
+}
+
+bool ReconnectingTransport::sendReports(const KeyboardModel& model,
+                                        const std::vector<std::uint8_t>& payload,
+                                        const std::vector<std::uint8_t>& dirty) {
+    return send(model, payload, &dirty);
+}
+
+// Device writes happen outside mutex_, so a slow write never blocks other
+// senders or stats; connected_ and catching_up_ decide who may use inner_.
+bool ReconnectingTransport::send(const KeyboardModel& model,
+                                 const std::vector<std::uint8_t>& payload,
+                                 const std::vector<std::uint8_t>* dirty) {
+    bool write = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        write = connected_ && !catching_up_;
+    }
+    if (write) {
+        const bool ok = dirty != nullptr ? inner_->sendReports(model, payload, *dirty)
+                                         : inner_->sendFrame(model, payload);
+        if (ok) {
+            return true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (write) {
+        connected_ = false;
+        std::cerr << "[ReconnectingTransport] " << inner_->id()
+                  << " write failed, reconnecting in the background" << '\n';
+    }
+    latest_.assign(payload.begin(), payload.end());
+    has_latest_ = true;
+    ++latest_generation_;
+    if (!model_) {
+        model_ = std::make_unique<KeyboardModel>(model);
+    }
+    cv_.notify_all();
+    return true;
+}
+
+void ReconnectingTransport::reconnectLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto delay = backoff_.initial;
+    // Expects mutex_ held
+    auto device_back = [this] {
+        if (connected_) {
+            return;
+        }
+        connected_ = true;
+        ++reconnects_;
+        std::cout << "[ReconnectingTransport] " << inner_->id() << " device back" << '\n';
+    };
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || (model_ && !connected_); });
+        if (stop_) {
+            break;
+        }
+        // Give a replugged device time to enumerate before the first try
+        if (cv_.wait_for(lock, delay, [this] { return stop_; })) {
+            break;
+        }
+        // model_ never changes once set
+        const KeyboardModel& model = *model_;
+        lock.unlock();
+        bool ok = inner_->connect(model);
+        lock.lock();
+
+        // The reconnect only counts once the held frame is on the device.
+        // Frames sent meanwhile replace it and the newest one is resent
+        // next; senders keep holding frames until this thread catches up.
+        catching_up_ = true;
+        while (ok && has_latest_ && !stop_) {
+            const auto generation = latest_generation_;
+            resend_.assign(latest_.begin(), latest_.end());
+            lock.unlock();
+            ok = inner_->sendFrame(model, resend_);
+            lock.lock();
+            if (!ok) {
+                break;
+            }
+            // Counted on the first write, even if newer frames keep it busy
+            device_back();
+            if (latest_generation_ == generation) {
+                has_latest_ = false;
+            }
+        }
+        catching_up_ = false;
+        if (stop_) {
+            break;
+        }
+        if (!ok) {
+            connected_ = false;
+            const auto next = std::chrono::duration<double, std::milli>(delay) * backoff_.multiplier;
+            delay = std::min(backoff_.max,
+                             std::chrono::duration_cast<std::chrono::milliseconds>(next));
+            continue;
+        }
+        device_back();
+        delay = backoff_.initial;
+    }
+}
+
+TransportStats ReconnectingTransport::transportStats() const {
+    auto stats = inner_->transportStats();
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.device_connected = connected_;
+    stats.reconnects = reconnects_;
+    return stats;
+}
+
+}  // namespace kb::cfg
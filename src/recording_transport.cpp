@@ -0,0 +1,76 @@
+#include "keyboard_configurator/recording_transport.hpp"
+
+#include <iostream>
+
+namespace kb::cfg {
+
+namespace {
+// Bounds what a crash can lose without a write per frame
+constexpr auto kFlushInterval = std::chrono::seconds(1);
+}  // namespace
+
+RecordingTransport::RecordingTransport(std::unique_ptr<DeviceTransport> inner, std::filesystem::path path)
+    : inner_(std::move(inner)), path_(std::move(path)) {}
+
+RecordingTransport::~RecordingTransport() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writer_) {
+        writer_->flush();
+        std::cout << "[RecordingTransport] Wrote " << writer_->frames() << " frames ("
+                  << writer_->bytesWritten() << " bytes) to " << path_.string() << '\n';
+    }
+}
+
+std::string RecordingTransport::id() const {
+    return inner_ ? inner_->id() : "record";
+}
+
+void RecordingTransport::open(const KeyboardModel& model) {
+    if (writer_) {
+        return;
+    }
+    writer_ = std::make_unique<CaptureWriter>(path_, CaptureHeader::fromModel(model));
+    start_ = std::chrono::steady_clock::now();
+    last_flush_ = start_;
+    std::cout << "[RecordingTransport] Recording frames to " << path_.string() << '\n';
+}
+
+bool RecordingTransport::connect(const KeyboardModel& model) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open(model);
+    }
+    return inner_ ? inner_->connect(model) : true;
+}
+
+bool RecordingTransport::sendFrame(const KeyboardModel& model,
+                                   const std::vector<std::uint8_t>& payload) {
+    record(model, payload);
+    return inner_ ? inner_->sendFrame(model, payload) : true;
+}
+
+bool RecordingTransport::sendReports(const KeyboardModel& model,
+                                     const std::vector<std::uint8_t>& payload,
+                                     const std::vector<std::uint8_t>& dirty) {
+    // Always the whole payload, so the capture does not depend on what the
+    // device held before
+    record(model, payload);
+    return inner_ ? inner_->sendReports(model, payload, dirty) : true;
+}
+
+TransportStats RecordingTransport::transportStats() const {
+    return inner_ ? inner_->transportStats() : TransportStats{};
+}
+
+void RecordingTransport::record(const KeyboardModel& model, const std::vector<std::uint8_t>& payload) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open(model);
+    const auto now = std::chrono::steady_clock::now();
+    writer_->append(std::chrono::duration_cast<std::chrono::microseconds>(now - start_), payload);
+    if (now - last_flush_ >= kFlushInterval) {
+        writer_->flush();
+        last_flush_ = now;
+    }
+}
+
+}  // namespace kb::cfg
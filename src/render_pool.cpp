@@ -0,0 +1,126 @@
+#include "keyboard_configurator/render_pool.hpp"
+
+namespace kb::cfg {
+
+RenderPool::RenderPool(std::size_t threads) {
+    const std::size_t workers = threads > 1 ? threads - 1 : 0;
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+RenderPool::~RenderPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void RenderPool::run(std::size_t count, const std::function<void(std::size_t)>& job) {
+    if (count == 0) {
+        return;
+    }
+    if (workers_.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        job_count_ = count;
+        next_job_ = 0;
+        pending_ = count;
+        error_ = nullptr;
+        ++generation_;
+    }
+    work_cv_.notify_all();
+
+    drain(job, count);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Workers still inside drain() hold a pointer to `job`; wait them out
+        // before it goes out of scope.
+        done_cv_.wait(lock, [this] { return pending_ == 0 && active_workers_ == 0; });
+        job_ = nullptr;
+        error = error_;
+        error_ = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void RenderPool::workerLoop() {
+    std::uint64_t seen_generation = 0;
+    while (true) {
+        const std::function<void(std::size_t)>* job = nullptr;
+        std::size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+            if (job_ == nullptr) {
+                continue;  // woke after the batch had already finished
+            }
+            job = job_;
+            count = job_count_;
+            ++active_workers_;
+        }
+
+        drain(*job, count);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_workers_;
+        }
+        done_cv_.notify_all();
+    }
+}
+
+void RenderPool::drain(const std::function<void(std::size_t)>& job, std::size_t count) {
+    while (true) {
+        std::size_t index = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (next_job_ >= count) {
+                return;
+            }
+            index = next_job_++;
+        }
+
+        try {
+            job(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+
+        bool batch_done = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch_done = --pending_ == 0;
+        }
+        if (batch_done) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+}  // namespace kb::cfg
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "keyboard_configurator/config_loader.hpp"
+#include "keyboard_configurator/frame_capture.hpp"
+#include "keyboard_configurator/simulated_transport.hpp"
+
+using kb::cfg::CaptureReader;
+using kb::cfg::createTransport;
+using kb::cfg::SimulatedTransport;
+
+namespace {
+
+void printUsage(const char* argv0)
+{
+    std::cerr << "Usage: " << argv0 << " <capture.kbcap> [options]\n"
+              << "  --transport <id>   hidapi (default), hidraw, logging or simulated\n"
+              << "  --max-rate         send back to back instead of at the recorded times\n"
+              << "  --loop <n>         play the capture n times (default 1)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::string capture_path = argv[1];
+    std::string transport_id = "hidapi";
+    bool max_rate = false;
+    long loops = 1;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--transport" && i + 1 < argc) {
+            transport_id = argv[++i];
+        } else if (arg == "--max-rate") {
+            max_rate = true;
+        } else if (arg == "--loop" && i + 1 < argc) {
+            loops = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    try {
+        CaptureReader reader(capture_path);
+        const auto model = reader.header().toModel();
+        auto transport = createTransport(transport_id);
+        if (!transport->connect(model)) {
+            std::cerr << "Failed to connect to " << model.name() << '\n';
+            return 1;
+        }
+
+        std::uint64_t frames = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t failures = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (long loop = 0; loop < loops; ++loop) {
+            reader.rewind();
+            const auto loop_start = std::chrono::steady_clock::now();
+            while (reader.next()) {
+                if (!max_rate) {
+                    std::this_thread::sleep_until(loop_start + reader.timestamp());
+                }
+                if (!transport->sendFrame(model, reader.payload())) {
+                    ++failures;
+                }
+                ++frames;
+                bytes += reader.payload().size();
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Replayed " << frames << " frames (" << bytes << " bytes) to "
+                  << transport->id() << " in " << seconds << " s" << '\n';
+        if (seconds > 0.0) {
+            std::cout << "  " << static_cast<double>(frames) / seconds << " frames/s, "
+                      << static_cast<double>(bytes) / seconds / 1024.0 << " KiB/s" << '\n';
+        }
+        std::cout << "  send failures: " << failures << '\n';
+        if (const auto* simulated = dynamic_cast<const SimulatedTransport*>(transport.get())) {
+            // Frames the simulated device rejected against the captured report layout
+            std::cout << "  malformed frames: " << simulated->counters().malformed << '\n';
+        }
+        return failures == 0 ? 0 : 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "Fatal error: " << ex.what() << "\n";
+        return 1;
+    }
+}
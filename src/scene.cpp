@@ -0,0 +1,21 @@
+#include "keyboard_configurator/scene.hpp"
+
+namespace kb::cfg {
+
+void Scene::setMask(std::size_t index, KeyMask mask) {
+    auto updated = masks ? std::make_shared<MaskSet>(*masks) : std::make_shared<MaskSet>();
+    if (updated->size() <= index) {
+        updated->resize(index + 1);
+    }
+    (*updated)[index] = std::move(mask);
+    masks = std::move(updated);
+}
+
+void Scene::setParameter(std::size_t index, const std::string& key, const std::string& value) {
+    if (parameters.size() <= index) {
+        parameters.resize(index + 1);
+    }
+    parameters[index][key] = value;
+}
+
+}  // namespace kb::cfg
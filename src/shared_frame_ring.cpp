@@ -0,0 +1,231 @@
+#include "keyboard_configurator/shared_frame_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace kb::cfg {
+
+namespace {
+
+constexpr char kMagic[8] = {'K', 'B', 'R', 'I', 'N', 'G', '1', '\0'};
+constexpr std::size_t kAlign = 64;  // one cache line per slot start
+constexpr int kReadRetries = 8;
+
+std::size_t alignUp(std::size_t value) {
+    return (value + kAlign - 1) / kAlign * kAlign;
+}
+
+std::runtime_error shmError(const std::string& what, const std::string& name) {
+    return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+}
+
+template <typename T>
+T* at(void* base, std::size_t offset) {
+    return reinterpret_cast<T*>(static_cast<std::uint8_t*>(base) + offset);
+}
+
+template <typename T>
+const T* at(const void* base, std::size_t offset) {
+    return reinterpret_cast<const T*>(static_cast<const std::uint8_t*>(base) + offset);
+}
+
+// Checks everything readers index with, so a stale or foreign ring under the
+// same name is refused instead of dividing by zero or reading past the mapping.
+// Fields are 32-bit, so none of the sums below can overflow a size_t.
+bool compatible(const SharedRingHeader& header, std::size_t size) {
+    const std::size_t keys = header.key_count;
+    const std::size_t geometry_end = std::size_t{header.geometry_offset} + keys * 4 * sizeof(float);
+    const std::size_t present_end = std::size_t{header.present_offset} + keys;
+    return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+           header.version == SharedFrameRing::kVersion &&
+           header.slot_count > 0 &&
+           header.geometry_offset >= sizeof(SharedRingHeader) &&
+           header.present_offset >= sizeof(SharedRingHeader) &&
+           header.geometry_offset % alignof(float) == 0 &&
+           header.slots_offset % alignof(SharedRingSlot) == 0 &&
+           header.slot_stride % alignof(SharedRingSlot) == 0 &&
+           geometry_end <= header.slots_offset && present_end <= header.slots_offset &&
+           sizeof(SharedRingSlot) + keys * sizeof(RgbColor) <= header.slot_stride &&
+           std::size_t{header.slots_offset} + std::size_t{header.slot_count} * header.slot_stride <= size;
+}
+
+}  // namespace
+
+SharedFrameRing::SharedFrameRing(const std::string& name, const KeyboardModel& model, std::size_t slots,
+                                 std::uint32_t mode)
+    : name_(name), key_count_(static_cast<std::uint32_t>(model.keyCount())) {
+    slots = std::clamp<std::size_t>(slots, 2, 64);
+    const std::size_t geometry_offset = alignUp(sizeof(SharedRingHeader));
+    const std::size_t present_offset = geometry_offset + key_count_ * 4 * sizeof(float);
+    const std::size_t slots_offset = alignUp(present_offset + key_count_);
+    const std::size_t slot_stride = alignUp(sizeof(SharedRingSlot) + key_count_ * sizeof(RgbColor));
+    size_ = slots_offset + slots * slot_stride;
+
+    // Replace a ring left behind by a previous run, whatever its size
+    ::shm_unlink(name_.c_str());
+    const int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, static_cast<mode_t>(mode));
+    if (fd < 0) {
+        throw shmError("Failed to create shared memory", name_);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        const auto error = shmError("Failed to size shared memory", name_);
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw error;
+    }
+    base_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        const auto error = shmError("Failed to map shared memory", name_);
+        ::shm_unlink(name_.c_str());
+        throw error;
+    }
+
+    // Static part first; the magic goes in last so a reader never sees a
+    // half-written header.
+    auto* header = new (base_) SharedRingHeader{};
+    header->version = kVersion;
+    header->key_count = key_count_;
+    header->slot_count = static_cast<std::uint32_t>(slots);
+    header->slot_stride = static_cast<std::uint32_t>(slot_stride);
+    header->geometry_offset = static_cast<std::uint32_t>(geometry_offset);
+    header->present_offset = static_cast<std::uint32_t>(present_offset);
+    header->slots_offset = static_cast<std::uint32_t>(slots_offset);
+    header->frames_published.store(0, std::memory_order_relaxed);
+
+    const auto& rects = model.geometry().rects();
+    auto* geometry = at<float>(base_, geometry_offset);
+    for (std::size_t k = 0; k < key_count_ && k < rects.size(); ++k) {
+        geometry[k * 4 + 0] = static_cast<float>(rects[k].x);
+        geometry[k * 4 + 1] = static_cast<float>(rects[k].y);
+        geometry[k * 4 + 2] = static_cast<float>(rects[k].width);
+        geometry[k * 4 + 3] = static_cast<float>(rects[k].height);
+    }
+    const auto& labels = model.keyLabels();
+    auto* present = at<std::uint8_t>(base_, present_offset);
+    for (std::size_t k = 0; k < key_count_; ++k) {
+        present[k] = k < labels.size() && labels[k] != "NAN" ? 1 : 0;
+    }
+    for (std::size_t s = 0; s < slots; ++s) {
+        new (at<void>(base_, slots_offset + s * slot_stride)) SharedRingSlot{};
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kMagic, sizeof(kMagic));
+}
+
+SharedFrameRing::~SharedFrameRing() {
+    if (base_ != nullptr) {
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+    }
+}
+
+void SharedFrameRing::publish(const KeyColorFrame& frame) {
+    auto* header = static_cast<SharedRingHeader*>(base_);
+    const std::uint64_t number = published_ + 1;
+    auto* slot = at<SharedRingSlot>(base_, header->slots_offset +
+                                               (number - 1) % header->slot_count * header->slot_stride);
+
+    const std::uint64_t seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->frame_number = number;
+    slot->timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch()).count();
+    auto* colors = reinterpret_cast<RgbColor*>(slot + 1);
+    const std::size_t count = std::min<std::size_t>(frame.size(), key_count_);
+    std::copy_n(frame.data(), count, colors);
+    std::fill(colors + count, colors + key_count_, RgbColor{});
+
+    slot->seq.store(seq + 2, std::memory_order_release);
+    header->frames_published.store(number, std::memory_order_release);
+    published_ = number;
+}
+
+SharedFrameReader::SharedFrameReader(const std::string& name) {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw shmError("Failed to open shared memory", name);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(SharedRingHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Shared memory " + name + " is not a frame ring");
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    void* base = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw shmError("Failed to map shared memory", name);
+    }
+    base_ = base;
+    if (!compatible(*static_cast<const SharedRingHeader*>(base_), size_)) {
+        ::munmap(const_cast<void*>(base_), size_);
+        base_ = nullptr;
+        throw std::runtime_error("Shared memory " + name + " is not a compatible frame ring");
+    }
+}
+
+SharedFrameReader::~SharedFrameReader() {
+    if (base_ != nullptr) {
+        ::munmap(const_cast<void*>(base_), size_);
+    }
+}
+
+std::size_t SharedFrameReader::keyCount() const noexcept {
+    return static_cast<const SharedRingHeader*>(base_)->key_count;
+}
+
+std::vector<KeyRect> SharedFrameReader::rects() const {
+    const auto* header = static_cast<const SharedRingHeader*>(base_);
+    const auto* geometry = at<float>(base_, header->geometry_offset);
+    std::vector<KeyRect> rects(header->key_count);
+    for (std::size_t k = 0; k < rects.size(); ++k) {
+        rects[k] = {geometry[k * 4 + 0], geometry[k * 4 + 1], geometry[k * 4 + 2], geometry[k * 4 + 3]};
+    }
+    return rects;
+}
+
+std::vector<std::uint8_t> SharedFrameReader::presentMask() const {
+    const auto* header = static_cast<const SharedRingHeader*>(base_);
+    const auto* present = at<std::uint8_t>(base_, header->present_offset);
+    return std::vector<std::uint8_t>(present, present + header->key_count);
+}
+
+bool SharedFrameReader::readLatest(std::vector<RgbColor>& colors, std::uint64_t& frame_number) const {
+    const auto* header = static_cast<const SharedRingHeader*>(base_);
+    colors.resize(header->key_count);
+    for (int attempt = 0; attempt < kReadRetries; ++attempt) {
+        const std::uint64_t published = header->frames_published.load(std::memory_order_acquire);
+        if (published == 0) {
+            return false;
+        }
+        const auto* slot = at<SharedRingSlot>(base_, header->slots_offset +
+                                                         (published - 1) % header->slot_count * header->slot_stride);
+        const std::uint64_t before = slot->seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        const std::uint64_t number = slot->frame_number;
+        std::copy_n(reinterpret_cast<const RgbColor*>(slot + 1), colors.size(), colors.data());
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) == before) {
+            frame_number = number;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace kb::cfg
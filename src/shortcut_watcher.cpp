@@ -26,35 +26,48 @@ static inline bool is_super(int code) { return code == KEY_LEFTMETA || code == K
 ShortcutWatcher::ShortcutWatcher(const KeyboardModel& model,
                                  ConfiguratorCLI& cli,
                                  const HyprConfig& hypr,
-                                 std::size_t key_count)
-    : model_(model), cli_(cli), hypr_(hypr), key_count_(key_count) {
-    
-    if (hypr_.shortcuts_overlay_preset_index >= 0) {
-        overlay_index_ = static_cast<std::size_t>(hypr_.shortcuts_overlay_preset_index);
-        overlay_valid_ = true;
+                                 std::size_t key_count) {
+    addTarget(model, cli, hypr, key_count);
+}
+
+ShortcutWatcher::~ShortcutWatcher() { stop(); }
+
+void ShortcutWatcher::addTarget(const KeyboardModel& model,
+                                ConfiguratorCLI& cli,
+                                const HyprConfig& hypr,
+                                std::size_t key_count) {
+    Target target;
+    target.model = &model;
+    target.cli = &cli;
+    target.hypr = hypr;
+    target.key_count = key_count;
+    if (hypr.shortcuts_overlay_preset_index >= 0) {
+        target.overlay_index = static_cast<std::size_t>(hypr.shortcuts_overlay_preset_index);
+        target.overlay_valid = true;
     }
 
-    for (const auto& kv : hypr_.shortcuts) {
+    for (const auto& kv : hypr.shortcuts) {
         CompiledProfile cp;
         for (const auto& ck : kv.second.combos) {
             int modmask = ck.first;
             std::vector<std::size_t> indices;
             indices.reserve(ck.second.size());
             for (const auto& label : ck.second) {
-                if (auto idx = model_.indexForKey(label)) {
+                if (auto idx = model.indexForKey(label)) {
                     indices.push_back(*idx);
                 }
             }
             cp.combos.emplace(modmask, std::move(indices));
         }
-        compiled_.emplace(kv.first, std::move(cp));
+        target.compiled.emplace(kv.first, std::move(cp));
     }
+    targets_.push_back(std::move(target));
 }
 
-ShortcutWatcher::~ShortcutWatcher() { stop(); }
-
 void ShortcutWatcher::start() {
-    if (!overlay_valid_) return;
+    const bool any_overlay = std::any_of(targets_.begin(), targets_.end(),
+                                         [](const Target& t) { return t.overlay_valid; });
+    if (!any_overlay) return;
     if (thread_.joinable()) return;
     stop_.store(false);
     openDevices();
@@ -69,19 +82,21 @@ void ShortcutWatcher::stop() {
     closeDevices();
 }
 
-bool ShortcutWatcher::setActiveClass(const std::string& klass) {
+bool ShortcutWatcher::setActiveClass(const std::string& klass, std::size_t target) {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
-    active_class_ = klass;
-    updateActiveShortcutFromClass();
+    if (target >= targets_.size()) return false;
+    auto& t = targets_[target];
+    t.active_class = klass;
+    updateActiveShortcutFromClass(t);
     
     // If we are NOT currently showing shortcuts, we might need to update the background profile immediately
     // But usually HyprlandWatcher handles the normal switching.
     // We only need to care if we ARE showing shortcuts, to ensure the "restore" target is correct.
     
     // Re-apply mods to ensure logic stays consistent
-    applyMaskForMods(mods_.load());
+    applyMaskForMods(t, mods_.load());
     
-    return engaged_;
+    return t.engaged;
 }
 
 void ShortcutWatcher::openDevices() {
@@ -126,8 +141,13 @@ void ShortcutWatcher::closeDevices() {
 }
 
 void ShortcutWatcher::runLoop() {
-    updateActiveShortcutFromClass();
-    applyMaskForMods(0);
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        for (auto& t : targets_) {
+            updateActiveShortcutFromClass(t);
+            applyMaskForMods(t, 0);
+        }
+    }
 
     while (!stop_.load()) {
         int combined = 0;
@@ -158,115 +178,126 @@ void ShortcutWatcher::runLoop() {
         }
         if (combined != mods_.load()) {
             mods_.store(combined);
-            applyMaskForMods(combined);
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            for (auto& t : targets_) {
+                applyMaskForMods(t, combined);
+            }
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
 }
 
-void ShortcutWatcher::updateActiveShortcutFromClass() {
+void ShortcutWatcher::updateActiveShortcutFromClass(Target& target) {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
+    const auto& hypr = target.hypr;
     std::string name;
-    auto it = hypr_.class_to_shortcut.find(active_class_);
-    if (it != hypr_.class_to_shortcut.end()) name = it->second;
-    if (name.empty()) name = hypr_.default_shortcut;
+    auto it = hypr.class_to_shortcut.find(target.active_class);
+    if (it != hypr.class_to_shortcut.end()) name = it->second;
+    if (name.empty()) name = hypr.default_shortcut;
     
-    active_shortcut_name_ = name;
+    target.active_shortcut_name = name;
     
     // If overlay currently active, update its color immediately
-    if (overlay_valid_ && engaged_) {
-        auto sit = hypr_.shortcuts.find(active_shortcut_name_);
-        if (sit != hypr_.shortcuts.end() && !sit->second.color.empty()) {
-            cli_.applyPresetParameter(overlay_index_, "color", sit->second.color);
+    if (target.overlay_valid && target.engaged) {
+        auto sit = hypr.shortcuts.find(target.active_shortcut_name);
+        if (sit != hypr.shortcuts.end() && !sit->second.color.empty()) {
+            target.cli->applyPresetParameter(target.overlay_index, "color", sit->second.color);
         }
     }
 }
 
 // --- Helper to restore state based on Active Window ---
-void ShortcutWatcher::restoreActiveProfile() {
-    std::lock_guard<std::recursive_mutex> lock(mutex_);
+void ShortcutWatcher::stageActiveProfile(const Target& target, Scene& scene) {
+    const auto& hypr = target.hypr;
     // 1. Determine which profile SHOULD be active
-    std::string prof = hypr_.default_profile;
-    auto pit = hypr_.class_to_profile.find(active_class_);
-    if (pit != hypr_.class_to_profile.end()) {
+    std::string prof = hypr.default_profile;
+    auto pit = hypr.class_to_profile.find(target.active_class);
+    if (pit != hypr.class_to_profile.end()) {
         prof = pit->second;
     }
 
     // 2. Look up the Draw List & Masks for that profile
     // (This logic mirrors HyprlandWatcher)
-    auto oit = hypr_.profile_draw_order.find(prof);
-    auto mit = hypr_.profile_masks.find(prof);
+    auto oit = hypr.profile_draw_order.find(prof);
+    auto mit = hypr.profile_masks.find(prof);
 
-    if (oit != hypr_.profile_draw_order.end() && mit != hypr_.profile_masks.end()) {
-        // 3. Apply them
-        cli_.applyPresetMasks(mit->second);
-        cli_.setDrawList(oit->second);
+    if (oit != hypr.profile_draw_order.end() && mit != hypr.profile_masks.end()) {
+        // 3. Stage them
+        scene.masks = mit->second;
+        scene.draw_list = oit->second;
     } else {
         // Fallback: If profile missing, maybe clear everything?
-        cli_.setDrawList({});
+        scene.draw_list.clear();
     }
-    cli_.refreshRender();
 }
 
-void ShortcutWatcher::applyMaskForMods(int modmask) {
+void ShortcutWatcher::applyMaskForMods(Target& target, int modmask) {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
-    if (!overlay_valid_) return;
+    if (!target.overlay_valid) return;
+    const auto& hypr = target.hypr;
+    const std::size_t overlay_index = target.overlay_index;
 
     // Calculate mask based on active shortcut profile + mods
-    std::vector<bool> mask(key_count_, false);
+    KeyMask mask(target.key_count);
     std::string used_profile;
     
     auto build_from = [&](const std::string& pname) -> bool {
         if (pname.empty()) return false;
-        auto it = compiled_.find(pname);
-        if (it == compiled_.end()) return false;
+        auto it = target.compiled.find(pname);
+        if (it == target.compiled.end()) return false;
         auto jt = it->second.combos.find(modmask);
         if (jt == it->second.combos.end()) return false;
         for (auto idx : jt->second) {
-            if (idx < mask.size()) mask[idx] = true;
+            if (idx < mask.size()) mask.set(idx);
         }
         used_profile = pname;
         return true;
     };
     
-    bool found = build_from(active_shortcut_name_);
-    if (!found && hypr_.default_shortcut != active_shortcut_name_) {
-        found = build_from(hypr_.default_shortcut);
+    bool found = build_from(target.active_shortcut_name);
+    if (!found && hypr.default_shortcut != target.active_shortcut_name) {
+        found = build_from(hypr.default_shortcut);
     }
 
-    const bool has_any = std::any_of(mask.begin(), mask.end(), [](bool b){ return b; });
+    const bool has_any = mask.any();
 
     if (modmask != 0 && has_any) {
         // === ENGAGE SHORTCUTS ===
-        if (!engaged_) {
-            // Force DrawList to ONLY be the overlay preset
-            std::vector<std::size_t> overlay_only = { overlay_index_ };
-            cli_.setDrawList(overlay_only);
-            engaged_ = true;
-        }
-
-        // Update Color if needed
+        // Draw list, color and mask go out as one scene so no frame shows the
+        // overlay with a stale color or mask.
+        std::string color;
         if (!used_profile.empty()) {
-            auto sit = hypr_.shortcuts.find(used_profile);
-            if (sit != hypr_.shortcuts.end() && !sit->second.color.empty()) {
-                cli_.applyPresetParameter(overlay_index_, "color", sit->second.color);
+            auto sit = hypr.shortcuts.find(used_profile);
+            if (sit != hypr.shortcuts.end()) {
+                color = sit->second.color;
             }
         }
-        
-        // Update Mask (Show specific keys)
-        cli_.applyPresetMask(overlay_index_, mask);
-        cli_.refreshRender();
-        
+        const bool engaging = !target.engaged;
+        target.cli->updateScene([&](Scene& scene) {
+            if (engaging) {
+                // Force DrawList to ONLY be the overlay preset
+                scene.draw_list = { overlay_index };
+            }
+            if (!color.empty()) {
+                scene.setParameter(overlay_index, "color", color);
+            }
+            // Update Mask (Show specific keys)
+            scene.setMask(overlay_index, mask);
+        });
+        target.engaged = true;
+        target.cli->refreshRender();
+
     } else {
         // === DISENGAGE (RESTORE) ===
-        if (engaged_) {
+        if (target.engaged) {
             // Instead of restoring a saved list, we recalculate the correct list
-            // for the current active window.
-            restoreActiveProfile();
-            
-            // Clean up overlay state
-            cli_.applyPresetMask(overlay_index_, std::vector<bool>(key_count_, false));
-            engaged_ = false;
+            // for the current active window, and clear the overlay in the same step.
+            target.cli->updateScene([&target](Scene& scene) {
+                stageActiveProfile(target, scene);
+                scene.setMask(target.overlay_index, KeyMask(target.key_count));
+            });
+            target.engaged = false;
+            target.cli->refreshRender();
         }
     }
 }
@@ -0,0 +1,203 @@
+#include "keyboard_configurator/simulated_transport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace kb::cfg {
+
+namespace {
+
+// z-score of the 99th percentile of a standard normal
+constexpr double kZ99 = 2.3263;
+
+}  // namespace
+
+SimulatedTransport::SimulatedTransport(Profile profile)
+    : profile_(profile),
+      rng_(profile.seed != 0
+               ? profile.seed
+               : static_cast<std::uint32_t>(Clock::now().time_since_epoch().count())) {
+    // median = e^mu and p99 = e^(mu + z99 * sigma)
+    const double median = static_cast<double>(profile_.latency.count());
+    const double p99 = static_cast<double>(profile_.latency_p99.count());
+    if (median > 0.0 && p99 > median) {
+        latency_us_ = std::lognormal_distribution<double>(std::log(median),
+                                                          std::log(p99 / median) / kZ99);
+    }
+}
+
+std::string SimulatedTransport::id() const {
+    return "simulated";
+}
+
+bool SimulatedTransport::connect(const KeyboardModel& model) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Clock::now() < unplugged_until_) {
+            return false;
+        }
+    }
+    model_ = std::make_unique<KeyboardModel>(model);
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = true;
+    ++counters_.connects;
+    return true;
+}
+
+bool SimulatedTransport::sendFrame(const KeyboardModel& /*model*/,
+                                   const std::vector<std::uint8_t>& payload) {
+    return send(payload, nullptr);
+}
+
+bool SimulatedTransport::sendReports(const KeyboardModel& /*model*/,
+                                     const std::vector<std::uint8_t>& payload,
+                                     const std::vector<std::uint8_t>& dirty) {
+    return send(payload, &dirty);
+}
+
+// Frames are validated against the connected model, as a device only knows
+// its own protocol whatever the caller passes.
+bool SimulatedTransport::send(const std::vector<std::uint8_t>& payload,
+                              const std::vector<std::uint8_t>* dirty) {
+    if (!model_) {
+        std::cerr << "[SimulatedTransport] sendFrame called before connect" << '\n';
+        return false;
+    }
+    if (!validate(payload)) {
+        return false;
+    }
+    const std::size_t report_size = model_->packetLength();
+    for (std::size_t r = 0; r < model_->reportCount(); ++r) {
+        if (dirty && r < dirty->size() && (*dirty)[r] == 0) {
+            continue;
+        }
+        if (!writeReport(report_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SimulatedTransport::validate(const std::vector<std::uint8_t>& payload) {
+    const std::size_t report_size = model_->packetLength();
+    const auto& chunks = model_->reportChunks();
+    std::ostringstream problem;
+    if (payload.size() != model_->payloadSize()) {
+        problem << "payload is " << payload.size() << " bytes, expected "
+                << model_->payloadSize();
+    } else {
+        for (std::size_t r = 0; r < chunks.size(); ++r) {
+            const auto* report = payload.data() + r * report_size;
+            const auto& header = chunks[r].header;
+            if (!std::equal(header.begin(), header.end(), report)) {
+                problem << "report " << r << " has the wrong header";
+                break;
+            }
+            const std::size_t used = header.size() + chunks[r].key_count * 3;
+            if (std::any_of(report + std::min(used, report_size), report + report_size,
+                            [](std::uint8_t b) { return b != 0; })) {
+                problem << "report " << r << " has non-zero padding";
+                break;
+            }
+        }
+    }
+    const std::string message = problem.str();
+    if (message.empty()) {
+        return true;
+    }
+
+    bool first = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first = ++counters_.malformed == 1;
+        ++write_failures_;
+    }
+    if (first) {
+        std::cerr << "[SimulatedTransport] Malformed frame: " << message
+                  << " (further ones are only counted)" << '\n';
+    }
+    return false;
+}
+
+bool SimulatedTransport::writeReport(std::size_t size) {
+    const auto start = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!connected_) {
+            ++write_failures_;
+            return false;
+        }
+        if (profile_.unplug_chance > 0.0 && chance_(rng_) < profile_.unplug_chance) {
+            unplugLocked(start);
+            ++write_failures_;
+            return false;
+        }
+    }
+
+    double delay_us = static_cast<double>(profile_.latency.count());
+    if (profile_.latency_p99 > profile_.latency && profile_.latency.count() > 0) {
+        delay_us = latency_us_(rng_);
+    }
+    if (profile_.bytes_per_second > 0.0) {
+        delay_us += static_cast<double>(size) * 1e6 / profile_.bytes_per_second;
+    }
+    const bool stalled = profile_.stall_chance > 0.0 && chance_(rng_) < profile_.stall_chance;
+    if (stalled) {
+        delay_us += std::chrono::duration<double, std::micro>(profile_.stall).count();
+    }
+    const bool failed = profile_.error_chance > 0.0 && chance_(rng_) < profile_.error_chance;
+
+    std::this_thread::sleep_until(
+        start + std::chrono::microseconds(static_cast<std::int64_t>(std::llround(delay_us))));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stalled) {
+        ++counters_.stalls;
+    }
+    if (failed) {
+        ++counters_.errors;
+    }
+    // An unplug() during the write loses it, as pulling the cable would
+    if (failed || !connected_) {
+        ++write_failures_;
+        return false;
+    }
+    ++counters_.reports;
+    counters_.bytes += size;
+    return true;
+}
+
+TransportStats SimulatedTransport::transportStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TransportStats stats;
+    stats.writes = counters_.reports;
+    stats.write_failures = write_failures_;
+    stats.device_connected = connected_;
+    return stats;
+}
+
+SimulatedTransport::Counters SimulatedTransport::counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counters_;
+}
+
+bool SimulatedTransport::pluggedIn() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Clock::now() >= unplugged_until_;
+}
+
+void SimulatedTransport::unplug() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unplugLocked(Clock::now());
+}
+
+void SimulatedTransport::unplugLocked(Clock::time_point now) {
+    connected_ = false;
+    unplugged_until_ = now + profile_.unplugged;
+    ++counters_.unplugs;
+}
+
+}  // namespace kb::cfg
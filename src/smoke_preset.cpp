@@ -1,42 +1,23 @@
 #include "keyboard_configurator/smoke_preset.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cctype>
 #include <vector>
 
+#include "keyboard_configurator/color.hpp"
+
 namespace kb::cfg {
 
 namespace {
-RgbColor parseHexColor(const std::string& value) {
-    if (value.size() != 7 || value.front() != '#') {
-        return {255, 255, 255};
-    }
-    auto hexToComponent = [](char hi, char lo) -> std::uint8_t {
-        auto hexValue = [](char ch) -> int {
-            if (ch >= '0' && ch <= '9') return ch - '0';
-            char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
-            if (upper >= 'A' && upper <= 'F') return 10 + (upper - 'A');
-            return 0;
-        };
-        return static_cast<std::uint8_t>((hexValue(hi) << 4) | hexValue(lo));
-    };
-    return {
-        hexToComponent(value[1], value[2]),
-        hexToComponent(value[3], value[4]),
-        hexToComponent(value[5], value[6])
-    };
-}
-
 int fastfloor(double x) { return static_cast<int>(x >= 0 ? x : x - 1); }
 
 double lerp(double a, double b, double t) { return a + (b - a) * t; }
 
 double fade(double t) { return t*t*t*(t*(t*6-15)+10); }
 
-int p[512];
-bool p_init = false;
-int perm_table[256] = {
+const int perm_table[256] = {
     151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,
     140,36,103,30,69,142,8,99,37,240,21,10,23,190, 6,148,
     247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,
@@ -55,11 +36,18 @@ int perm_table[256] = {
     236,205, 93,222,114, 67,29, 24, 72,243,141,128,195,78,66
 };
 
-void ensure_perm() {
-    if (p_init) return;
-    for (int i = 0; i < 256; ++i) p[i] = perm_table[i];
-    for (int i = 0; i < 256; ++i) p[256 + i] = p[i];
-    p_init = true;
+// Doubled permutation table; built once, and the static initialisation is
+// thread-safe so smoke layers can render concurrently.
+const int* perm() {
+    static const auto table = [] {
+        std::array<int, 512> t{};
+        for (int i = 0; i < 256; ++i) {
+            t[i] = perm_table[i];
+            t[256 + i] = perm_table[i];
+        }
+        return t;
+    }();
+    return table.data();
 }
 
 inline double grad(int hash, double x, double y, double z) {
@@ -70,7 +58,7 @@ inline double grad(int hash, double x, double y, double z) {
 }
 
 double perlin(double x, double y, double z) {
-    ensure_perm();
+    const int* p = perm();
     int X = fastfloor(x) & 255;
     int Y = fastfloor(y) & 255;
     int Z = fastfloor(z) & 255;
@@ -106,6 +94,7 @@ void SmokePreset::configure(const ParameterMap& params) {
     if (auto it = params.find("contrast"); it != params.end()) contrast_ = std::max(0.0, std::stod(it->second));
     if (auto it = params.find("color_low"); it != params.end()) color_low_ = parseHexColor(it->second);
     if (auto it = params.find("color_high"); it != params.end()) color_high_ = parseHexColor(it->second);
+    lut_ = GradientLut::fromStops({color_low_, color_high_});
 
     auto parseBool = [](std::string v) {
         std::transform(v.begin(), v.end(), v.begin(), [](unsigned char c) {
@@ -136,37 +125,35 @@ void SmokePreset::configure(const ParameterMap& params) {
     }
 }
 
-void SmokePreset::buildCoords(const KeyboardModel& model) {
-    const auto& layout = model.layout();
-    std::size_t total = model.keyCount();
-    xs_.assign(total, 0.0);
-    ys_.assign(total, 0.0);
-    std::size_t idx = 0;
-    double rows = static_cast<double>(layout.size());
-    double max_cols = 1.0;
-    for (const auto& row : layout) max_cols = std::max<double>(max_cols, row.size());
-    for (std::size_t r = 0; r < layout.size(); ++r) {
-        const auto& row = layout[r];
-        for (std::size_t c = 0; c < row.size(); ++c) {
-            xs_[idx] = max_cols > 1.0 ? static_cast<double>(c) / (max_cols - 1.0) : 0.0;
-            ys_[idx] = rows > 1.0 ? static_cast<double>(r) / (rows - 1.0) : 0.0;
-            ++idx;
-        }
-    }
-    coords_built_ = true;
-}
-
 void SmokePreset::render(const KeyboardModel& model,
                          double time_seconds,
                          KeyColorFrame& frame) {
+    renderKeys(model, time_seconds, frame, nullptr);
+}
+
+void SmokePreset::renderVisible(const KeyboardModel& model,
+                                double time_seconds,
+                                KeyColorFrame& frame,
+                                const std::vector<std::size_t>& visible) {
+    renderKeys(model, time_seconds, frame, &visible);
+}
+
+void SmokePreset::renderKeys(const KeyboardModel& model,
+                             double time_seconds,
+                             KeyColorFrame& frame,
+                             const std::vector<std::size_t>* visible) {
     const auto total = model.keyCount();
     if (frame.size() != total) frame.resize(total);
-    if (!coords_built_) buildCoords(model);
+    const auto& geometry = model.geometry();
+    if (geometry.size() != total) return;
+    const auto& xs = geometry.xs();
+    const auto& ys = geometry.ys();
+    if (lut_.empty()) lut_ = GradientLut::fromStops({color_low_, color_high_});
 
     // Reactive Displacement (Same as before)
     std::vector<double> disp_x;
     std::vector<double> disp_y;
-    computeReactiveDisplacement(disp_x, disp_y);
+    computeReactiveDisplacement(geometry, disp_x, disp_y);
 
     double t_anim = time_seconds * speed_;
     
@@ -174,9 +161,12 @@ void SmokePreset::render(const KeyboardModel& model,
     double drift_x = time_seconds * drift_x_;
     double drift_y = time_seconds * drift_y_;
 
-    for (std::size_t i = 0; i < total; ++i) {
-        double base_x = xs_[i];
-        double base_y = ys_[i];
+    auto out = frame.span(total);
+    const std::size_t count = visible ? visible->size() : total;
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        const std::size_t i = visible ? (*visible)[slot] : slot;
+        double base_x = xs[i];
+        double base_y = ys[i];
 
         // Apply Reactive Push
         if (i < disp_x.size()) base_x = std::clamp(base_x + disp_x[i], 0.0, 1.0);
@@ -228,19 +218,19 @@ void SmokePreset::render(const KeyboardModel& model,
         v = std::pow(std::clamp(v, 0.0, 1.0), 3.0); 
 
         // Color Blending
-        RgbColor c{};
         // 'color_low_' is usually background (black/transparent)
         // 'color_high_' is the smoke color (gray/white)
-        c.r = static_cast<std::uint8_t>(std::clamp<int>(std::lround(lerp(color_low_.r, color_high_.r, v)), 0, 255));
-        c.g = static_cast<std::uint8_t>(std::clamp<int>(std::lround(lerp(color_low_.g, color_high_.g, v)), 0, 255));
-        c.b = static_cast<std::uint8_t>(std::clamp<int>(std::lround(lerp(color_low_.b, color_high_.b, v)), 0, 255));
-        frame.setColor(i, c);
+        out[i] = lut_.at(v);
     }
 }
 
-void SmokePreset::computeReactiveDisplacement(std::vector<double>& dx, std::vector<double>& dy) {
-    const std::size_t total = xs_.size();
-    if (!reactive_enabled_ || !provider_ || !coords_built_ || total == 0) {
+void SmokePreset::computeReactiveDisplacement(const KeyGeometry& geometry,
+                                              std::vector<double>& dx,
+                                              std::vector<double>& dy) {
+    const auto& xs = geometry.xs();
+    const auto& ys = geometry.ys();
+    const std::size_t total = xs.size();
+    if (!reactive_enabled_ || !provider_ || total == 0) {
         return;
     }
 
@@ -290,13 +280,14 @@ void SmokePreset::computeReactiveDisplacement(std::vector<double>& dx, std::vect
         // If the event is too old/weak (less than 0.5% effect), skip it.
         if (weight <= 0.005) continue;
 
-        const double ex = xs_[ev.key_index];
-        const double ey = ys_[ev.key_index];
+        const double ex = xs[ev.key_index];
+        const double ey = ys[ev.key_index];
 
-        // INNER LOOP
-        for (std::size_t k = 0; k < total; ++k) {
-            const double px = xs_[k] - ex;
-            const double py = ys_[k] - ey;
+        // INNER LOOP: only keys inside the cutoff radius
+        geometry.index().queryRadius(ex, ey, std::sqrt(cutoff_dist2), nearby_);
+        for (const std::size_t k : nearby_) {
+            const double px = xs[k] - ex;
+            const double py = ys[k] - ey;
             const double dist2 = px * px + py * py;
 
             // OPTIMIZATION 4: Spatial Skip
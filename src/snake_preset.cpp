@@ -6,13 +6,16 @@
 #include <limits>
 #include <linux/input-event-codes.h>
 
+#include "keyboard_configurator/color.hpp"
+
 namespace kb::cfg {
 
 namespace {
     std::mt19937& rng()
     {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
+        // Per thread, so layers rendered on the pool do not share a generator
+        thread_local std::random_device rd;
+        thread_local std::mt19937 gen(rd());
         return gen;
     }
 
@@ -169,34 +172,6 @@ void SnakePreset::processInput(const KeyboardModel& model)
     }
 }
 
-namespace {
-RgbColor hsvToRgb(double h, double s, double v)
-{
-    h = std::fmod(h, 360.0);
-    if (h < 0) h += 360.0;
-    s = std::clamp(s, 0.0, 1.0);
-    v = std::clamp(v, 0.0, 1.0);
-
-    double c = v * s;
-    double x = c * (1 - std::fabs(std::fmod(h / 60.0, 2) - 1));
-    double m = v - c;
-
-    double r = 0, g = 0, b = 0;
-    if (h < 60) { r = c; g = x; }
-    else if (h < 120) { r = x; g = c; }
-    else if (h < 180) { g = c; b = x; }
-    else if (h < 240) { g = x; b = c; }
-    else if (h < 300) { r = x; b = c; }
-    else { r = c; b = x; }
-
-    return {
-        static_cast<std::uint8_t>((r + m) * 255),
-        static_cast<std::uint8_t>((g + m) * 255),
-        static_cast<std::uint8_t>((b + m) * 255)
-    };
-}
-}
-
 void SnakePreset::randomizeColors()
 {
     std::uniform_real_distribution<double> hue_dist(0.0, 360.0);
@@ -357,6 +332,7 @@ void SnakePreset::render(const KeyboardModel& model, double time_seconds, KeyCol
     }
 
     const auto& layout = model.layout();
+    auto out = frame.span();
     size_t key_idx = 0;
     
     for (size_t r = 0; r < layout.size(); ++r) {
@@ -385,8 +361,8 @@ void SnakePreset::render(const KeyboardModel& model, double time_seconds, KeyCol
                     }
                 }
                 
-                if (key_idx < frame.size()) {
-                    frame.setColor(key_idx, color);
+                if (key_idx < out.size()) {
+                    out[key_idx] = color;
                 }
             }
             key_idx++;
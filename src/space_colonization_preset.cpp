@@ -5,13 +5,16 @@
 #include <limits>
 #include <random>
 
+#include "keyboard_configurator/color.hpp"
+
 namespace kb::cfg {
 
 namespace {
     std::mt19937& rng()
     {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
+        // Per thread, so layers rendered on the pool do not share a generator
+        thread_local std::random_device rd;
+        thread_local std::mt19937 gen(rd());
         return gen;
     }
 
@@ -20,23 +23,6 @@ namespace {
         return std::uniform_real_distribution<double>(0.0, 1.0)(rng());
     }
 
-    RgbColor parseHexColor(const std::string& value)
-    {
-        if (value.size() != 7 || value.front() != '#')
-            return { 255, 255, 255 };
-        auto hex = [](char ch) {
-            if (ch >= '0' && ch <= '9')
-                return ch - '0';
-            char u = std::toupper(ch);
-            return (u >= 'A' && u <= 'F') ? 10 + (u - 'A') : 0;
-        };
-        return {
-            static_cast<uint8_t>((hex(value[1]) << 4) | hex(value[2])),
-            static_cast<uint8_t>((hex(value[3]) << 4) | hex(value[4])),
-            static_cast<uint8_t>((hex(value[5]) << 4) | hex(value[6]))
-        };
-    }
-
     inline double distSq(const Vector2& a, const Vector2& b)
     {
         return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
@@ -94,11 +80,14 @@ void SpaceColonizationPreset::reset()
     last_real_time_ = 0;
 }
 
-void SpaceColonizationPreset::applyKeyActivityInjection(double now)
+void SpaceColonizationPreset::applyKeyActivityInjection(const KeyGeometry& geometry, double now)
 {
     if (!reactive_enabled_ || !key_activity_provider_)
         return;
 
+    const auto& xs = geometry.uniformXs();
+    const auto& ys = geometry.uniformYs();
+
     // Check if we have any live nodes (opacity > 0)
     bool has_live_nodes = false;
     for (const auto& n : nodes_) {
@@ -110,11 +99,11 @@ void SpaceColonizationPreset::applyKeyActivityInjection(double now)
 
     auto events = key_activity_provider_->recentEvents(0.1);
     for (const auto& ev : events) {
-        if (ev.key_index >= xs_.size())
+        if (ev.key_index >= xs.size())
             continue;
 
-        double kx = xs_[ev.key_index];
-        double ky = ys_[ev.key_index];
+        double kx = xs[ev.key_index];
+        double ky = ys[ev.key_index];
 
         if (!has_live_nodes) {
             // DYNAMIC ROOT: If no live nodes, this press is the seed.
@@ -206,13 +195,28 @@ void SpaceColonizationPreset::grow(double now)
 
 void SpaceColonizationPreset::render(const KeyboardModel& model, double time, KeyColorFrame& frame)
 {
-    if (!coords_built_) buildCoords(model);
+    renderKeys(model, time, frame, nullptr);
+}
+
+void SpaceColonizationPreset::renderVisible(const KeyboardModel& model, double time, KeyColorFrame& frame,
+                                            const std::vector<std::size_t>& visible)
+{
+    renderKeys(model, time, frame, &visible);
+}
+
+void SpaceColonizationPreset::renderKeys(const KeyboardModel& model, double time, KeyColorFrame& frame,
+                                         const std::vector<std::size_t>* keys)
+{
+    // Uniform scale keeps growth isotropic on wide layouts
+    const auto& geometry = model.geometry();
+    const auto& xs = geometry.uniformXs();
+    const auto& ys = geometry.uniformYs();
     double real_dt = (last_real_time_ > 0) ? (time - last_real_time_) : 0.016;
     last_real_time_ = time;
     if (real_dt < 0.0 || real_dt > 0.5) real_dt = 0.0;
     internal_time_ += real_dt;
 
-    applyKeyActivityInjection(internal_time_);
+    applyKeyActivityInjection(geometry, internal_time_);
 
     if (internal_time_ - last_growth_time_ > growth_interval_) {
         grow(internal_time_);
@@ -235,9 +239,13 @@ void SpaceColonizationPreset::render(const KeyboardModel& model, double time, Ke
 
     size_t total = model.keyCount();
     if (frame.size() != total) frame.resize(total);
+    if (xs.size() != total) return;
 
-    for (size_t i = 0; i < total; ++i) {
-        Vector2 kPos = { xs_[i], ys_[i] };
+    auto out = frame.span(total);
+    const size_t count = keys ? keys->size() : total;
+    for (size_t slot = 0; slot < count; ++slot) {
+        const size_t i = keys ? (*keys)[slot] : slot;
+        Vector2 kPos = { xs[i], ys[i] };
         double min_d2 = 1.0, best_opacity = 0.0, best_strength = 0.0, best_dist = 0.0;
         bool found = false;
 
@@ -266,13 +274,13 @@ void SpaceColonizationPreset::render(const KeyboardModel& model, double time, Ke
 
             double ratio = std::min(1.0, (best_dist * segment_len_) / 0.8);
 
-            frame.setColor(i, { 
+            out[i] = { 
                 (uint8_t)((color_root_.r * (1.0 - ratio) + color_tip_.r * ratio) * brightness),
                 (uint8_t)((color_root_.g * (1.0 - ratio) + color_tip_.g * ratio) * brightness),
                 (uint8_t)((color_root_.b * (1.0 - ratio) + color_tip_.b * ratio) * brightness) 
-            });
+            };
         } else {
-            frame.setColor(i, { 0, 0, 0 });
+            out[i] = { 0, 0, 0 };
         }
     }
     cleanupDeadNodes(internal_time_);
@@ -293,36 +301,4 @@ void SpaceColonizationPreset::cleanupDeadNodes(double now)
         reset();
     }
 }
-
-void SpaceColonizationPreset::buildCoords(const KeyboardModel& model)
-{
-    const auto& layout = model.layout();
-    size_t total = model.keyCount();
-    xs_.resize(total);
-    ys_.resize(total);
-
-    // 1. Calculate the actual grid dimensions
-    double max_rows = static_cast<double>(layout.size());
-    double max_cols = 0;
-    for (const auto& r : layout) {
-        max_cols = std::max(max_cols, static_cast<double>(r.size()));
-    }
-
-    // 2. Use a single scale factor to maintain a 1:1 aspect ratio.
-    // This prevents the "stretched" look where growth moves faster horizontally.
-    double scale = std::max(max_rows, max_cols);
-    if (scale < 1.0)
-        scale = 1.0;
-
-    size_t idx = 0;
-    for (size_t r = 0; r < layout.size(); ++r) {
-        for (size_t c = 0; c < layout[r].size(); ++c) {
-            // Mapping keys into a consistent coordinate space
-            xs_[idx] = static_cast<double>(c) / scale;
-            ys_[idx] = static_cast<double>(r) / scale;
-            idx++;
-        }
-    }
-    coords_built_ = true;
-}
 } // namespace kb::cfg
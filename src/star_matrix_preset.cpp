@@ -4,34 +4,9 @@
 #include <cmath>
 #include <cctype>
 
-namespace kb::cfg {
-
-namespace {
-inline RgbColor parseHexColor(const std::string& value) {
-    if (value.size() != 7 || value.front() != '#') {
-        return {255, 255, 255};
-    }
-    auto hexToComponent = [](char hi, char lo) -> std::uint8_t {
-        auto hexValue = [](char ch) -> int {
-            if (ch >= '0' && ch <= '9') return ch - '0';
-            char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
-            if (upper >= 'A' && upper <= 'F') return 10 + (upper - 'A');
-            return 0;
-        };
-        return static_cast<std::uint8_t>((hexValue(hi) << 4) | hexValue(lo));
-    };
-    return {
-        hexToComponent(value[1], value[2]),
-        hexToComponent(value[3], value[4]),
-        hexToComponent(value[5], value[6])
-    };
-}
+#include "keyboard_configurator/color.hpp"
 
-inline std::uint8_t mix8(std::uint8_t a, std::uint8_t b, double t) {
-    t = std::clamp(t, 0.0, 1.0);
-    return static_cast<std::uint8_t>(std::clamp<int>(static_cast<int>(std::lround(a + (b - a) * t)), 0, 255));
-}
-} // namespace
+namespace kb::cfg {
 
 StarMatrixPreset::StarMatrixPreset() = default;
 
@@ -50,6 +25,7 @@ void StarMatrixPreset::configure(const ParameterMap& params) {
     if (auto it = params.find("speed"); it != params.end()) {
         speed_ = std::max(0.0, std::stod(it->second));
     }
+    lut_ = GradientLut::fromStops({background_, star_color_});
 }
 
 std::uint32_t StarMatrixPreset::hash32(std::uint32_t x) {
@@ -64,14 +40,34 @@ std::uint32_t StarMatrixPreset::hash32(std::uint32_t x) {
 void StarMatrixPreset::render(const KeyboardModel& model,
                               double time_seconds,
                               KeyColorFrame& frame) {
+    renderKeys(model, time_seconds, frame, nullptr);
+}
+
+void StarMatrixPreset::renderVisible(const KeyboardModel& model,
+                                     double time_seconds,
+                                     KeyColorFrame& frame,
+                                     const std::vector<std::size_t>& visible) {
+    renderKeys(model, time_seconds, frame, &visible);
+}
+
+void StarMatrixPreset::renderKeys(const KeyboardModel& model,
+                                  double time_seconds,
+                                  KeyColorFrame& frame,
+                                  const std::vector<std::size_t>* visible) {
     const auto total = model.keyCount();
     if (frame.size() != total) {
         frame.resize(total);
     }
 
     const double two_pi = 6.283185307179586;
+    if (lut_.empty()) {
+        lut_ = GradientLut::fromStops({background_, star_color_});
+    }
 
-    for (std::size_t idx = 0; idx < total; ++idx) {
+    auto out = frame.span(total);
+    const std::size_t count = visible ? visible->size() : total;
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        const std::size_t idx = visible ? (*visible)[slot] : slot;
         // Deterministic pseudo-random seed per key
         std::uint32_t h = hash32(static_cast<std::uint32_t>(idx + 1));
         double s = static_cast<double>(h % 10000) / 10000.0; // [0,1)
@@ -86,11 +82,7 @@ void StarMatrixPreset::render(const KeyboardModel& model,
             // ease in/out
             b = b * b * (3.0 - 2.0 * b);
         }
-        RgbColor c{};
-        c.r = mix8(background_.r, star_color_.r, b);
-        c.g = mix8(background_.g, star_color_.g, b);
-        c.b = mix8(background_.b, star_color_.b, b);
-        frame.setColor(idx, c);
+        out[idx] = lut_.at(b);
     }
 }
 